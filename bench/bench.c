@@ -0,0 +1,632 @@
+// JsonCraftor benchmark suite
+//
+// Generates synthetic corpora, times parsing (and serialization) of each,
+// and prints one JSON object per benchmark so results can be saved and
+// diffed across versions:
+//
+//   make bench
+//   ./build/bench --out before.jsonl
+//   ./build/bench --perf --filter ndjson
+
+#include <stdlib.h>
+
+// Count the library's heap allocations
+static size_t alloc_count = 0;
+static void* counting_malloc(size_t size) { alloc_count++; return malloc(size); }
+static void* counting_calloc(size_t n, size_t size) { alloc_count++; return calloc(n, size); }
+static void* counting_realloc(void* ptr, size_t size) { alloc_count++; return realloc(ptr, size); }
+#define JC_MALLOC(size) counting_malloc(size)
+#define JC_CALLOC(count, size) counting_calloc(count, size)
+#define JC_REALLOC(ptr, size) counting_realloc(ptr, size)
+#define JC_FREE(ptr) free(ptr)
+
+#include "../jsoncraftor.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAVE_PERF 1
+#endif
+
+#define FLAT_FIELDS 16                  // Fields of each type in the flat object
+#define DEEP_LEVELS 32                  // Nesting depth of the deep corpus
+#define INT_VALUES 4096                 // Elements of the integer array
+#define STRING_VALUES 512               // Elements of the string array
+#define UNKNOWN_MAPPED 8                // Mapped fields in the unknown-heavy corpus
+#define UNKNOWN_EXTRA 32                // Unmapped fields in the unknown-heavy corpus
+#define NDJSON_RECORDS 10000            // Records in the NDJSON corpus
+
+typedef enum { MODE_PARSE, MODE_NDJSON, MODE_SERIALIZE, MODE_DOC, MODE_VALIDATE } bench_mode;
+
+// One benchmark: an input, the schema to parse it with and its size
+typedef struct bench_case {
+    const char* name;
+    bench_mode mode;
+    char* json;                 // Input document(s)
+    size_t len;                 // Input bytes
+    size_t docs;                // Documents per run
+    size_t fields;              // JSON values per run
+    jc_schema* schema;
+    void* base;                 // Destination struct (or record array)
+    jc_options opts;
+    size_t stride;              // NDJSON record size
+    jc_buffer out;              // Serializer output
+} bench_case;
+
+// Hardware counters for one measurement
+typedef struct bench_counters {
+    bool valid;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t branch_misses;
+} bench_counters;
+
+typedef struct bench_settings {
+    double run_seconds;         // Target duration of one timed run
+    int runs;                   // Timed runs; the median is reported
+    bool perf;                  // Read hardware counters
+    const char* filter;         // Only run benchmarks whose name contains this
+    FILE* out;                  // Where results go
+} bench_settings;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Growable text buffer used to build the corpora
+typedef struct text {
+    char* data;
+    size_t len;
+    size_t cap;
+} text;
+
+static void text_printf(text* t, const char* fmt, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(t->data + t->len, t->cap - t->len, fmt, args);
+        va_end(args);
+        if (n >= 0 && (size_t)n < t->cap - t->len) {
+            t->len += (size_t)n;
+            return;
+        }
+        t->cap = t->cap ? t->cap * 2 : 4096;
+        t->data = realloc(t->data, t->cap);
+        if (!t->data) {
+            fprintf(stderr, "bench: out of memory\n");
+            exit(1);
+        }
+    }
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void random_word(char* out, size_t len) {
+    for (size_t i = 0; i < len; i++) out[i] = (char)('a' + rng_next() % 26);
+    out[len] = '\0';
+}
+
+static jc_schema* compile_or_die(const JsonMap* maps, int count, bool offsets) {
+    char* error = NULL;
+    jc_schema* schema = offsets ? jc_schema_compile_offsets(maps, count, &error)
+                                : jc_schema_compile(maps, count, &error);
+    if (!schema) {
+        fprintf(stderr, "bench: schema compilation failed: %s\n", error);
+        exit(1);
+    }
+    return schema;
+}
+
+// Wide flat object: ints, doubles, strings and bools, all mapped
+typedef struct flat_record {
+    int ints[FLAT_FIELDS];
+    double doubles[FLAT_FIELDS];
+    char strings[FLAT_FIELDS][24];
+    bool bools[FLAT_FIELDS];
+} flat_record;
+
+static char flat_keys[4 * FLAT_FIELDS][8];
+
+static jc_schema* flat_schema(void) {
+    JsonMap maps[4 * FLAT_FIELDS];
+    for (int i = 0; i < FLAT_FIELDS; i++) {
+        sprintf(flat_keys[i], "i%d", i);
+        sprintf(flat_keys[FLAT_FIELDS + i], "d%d", i);
+        sprintf(flat_keys[2 * FLAT_FIELDS + i], "s%d", i);
+        sprintf(flat_keys[3 * FLAT_FIELDS + i], "b%d", i);
+        maps[i] = (JsonMap){flat_keys[i], JC_OFFSET(flat_record, ints[i]), 'i', 0, true, NULL};
+        maps[FLAT_FIELDS + i] = (JsonMap){flat_keys[FLAT_FIELDS + i], JC_OFFSET(flat_record, doubles[i]),
+                                          'd', 0, true, NULL};
+        maps[2 * FLAT_FIELDS + i] = (JsonMap){flat_keys[2 * FLAT_FIELDS + i], JC_OFFSET(flat_record, strings[i]),
+                                              's', 24, true, NULL};
+        maps[3 * FLAT_FIELDS + i] = (JsonMap){flat_keys[3 * FLAT_FIELDS + i], JC_OFFSET(flat_record, bools[i]),
+                                              'b', 0, true, NULL};
+    }
+    return compile_or_die(maps, 4 * FLAT_FIELDS, true);
+}
+
+// Write the flat object, minified or pretty-printed
+static void flat_json(text* t, bool pretty) {
+    const char* sep = pretty ? ",\n    " : ",";
+    text_printf(t, pretty ? "{\n    " : "{");
+    for (int i = 0; i < 4 * FLAT_FIELDS; i++) {
+        const char* key = flat_keys[i];
+        const char* colon = pretty ? ": " : ":";
+        if (i) text_printf(t, "%s", sep);
+        switch (key[0]) {
+            case 'i':
+                text_printf(t, "\"%s\"%s%d", key, colon, (int)(rng_next() % 2000000) - 1000000);
+                break;
+            case 'd':
+                text_printf(t, "\"%s\"%s%.17g", key, colon, (double)(rng_next() % 1000000) / 997.0);
+                break;
+            case 's': {
+                char word[24];
+                random_word(word, 8 + rng_next() % 12);
+                text_printf(t, "\"%s\"%s\"%s\"", key, colon, word);
+                break;
+            }
+            default:
+                text_printf(t, "\"%s\"%s%s", key, colon, rng_next() % 2 ? "true" : "false");
+                break;
+        }
+    }
+    text_printf(t, pretty ? "\n}\n" : "}");
+}
+
+// Deeply nested objects, one mapped integer per level
+static int deep_values[DEEP_LEVELS];
+static int deep_anchor;
+static JsonMap deep_maps[DEEP_LEVELS][2];
+
+static jc_schema* deep_schema(void) {
+    for (int i = DEEP_LEVELS - 1; i >= 0; i--) {
+        deep_maps[i][0] = (JsonMap){"v", &deep_values[i], 'i', 0, true, NULL};
+        deep_maps[i][1] = (JsonMap){"next", &deep_anchor, 'o', 2, false,
+                                    i + 1 < DEEP_LEVELS ? deep_maps[i + 1] : NULL};
+    }
+    deep_maps[DEEP_LEVELS - 1][1].size = 0;
+    return compile_or_die(deep_maps[0], 2, false);
+}
+
+static void deep_json(text* t) {
+    for (int i = 0; i < DEEP_LEVELS; i++) {
+        text_printf(t, "{\"v\":%d%s", i * 7, i + 1 < DEEP_LEVELS ? ",\"next\":" : "");
+    }
+    for (int i = 0; i < DEEP_LEVELS; i++) text_printf(t, "}");
+}
+
+// Long arrays of integers (variable length, arena-backed) and strings,
+// copied or interned
+typedef struct array_record {
+    jc_array ints;
+    char strings[STRING_VALUES][32];
+    const char* interned[STRING_VALUES];
+} array_record;
+
+static JsonMap int_item = {"item", NULL, 'i', 0, true, NULL};
+static JsonMap string_item = {"item", NULL, 's', 32, true, NULL};
+static JsonMap interned_item = {"item", NULL, 'n', 0, true, NULL};
+
+static jc_schema* int_array_schema(void) {
+    JsonMap maps[] = {{"values", JC_OFFSET(array_record, ints), 'v', 0, true, &int_item}};
+    return compile_or_die(maps, 1, true);
+}
+
+static jc_schema* string_array_schema(void) {
+    JsonMap maps[] = {{"names", JC_OFFSET(array_record, strings), 'a', STRING_VALUES, true, &string_item}};
+    return compile_or_die(maps, 1, true);
+}
+
+static jc_schema* interned_array_schema(void) {
+    JsonMap maps[] = {{"names", JC_OFFSET(array_record, interned), 'a', STRING_VALUES, true, &interned_item}};
+    return compile_or_die(maps, 1, true);
+}
+
+static void int_array_json(text* t) {
+    text_printf(t, "{\"values\":[");
+    for (int i = 0; i < INT_VALUES; i++) {
+        text_printf(t, "%s%d", i ? "," : "", (int)(rng_next() % 100000000));
+    }
+    text_printf(t, "]}");
+}
+
+static void string_array_json(text* t) {
+    text_printf(t, "{\"names\":[");
+    for (int i = 0; i < STRING_VALUES; i++) {
+        char word[32];
+        random_word(word, 4 + rng_next() % 24);
+        text_printf(t, "%s\"%s\"", i ? "," : "", word);
+    }
+    text_printf(t, "]}");
+}
+
+// Mostly unmapped fields: nested objects, arrays and strings to skip
+typedef struct unknown_record {
+    int mapped[UNKNOWN_MAPPED];
+} unknown_record;
+
+static char unknown_keys[UNKNOWN_MAPPED][8];
+
+static jc_schema* unknown_schema(void) {
+    JsonMap maps[UNKNOWN_MAPPED];
+    for (int i = 0; i < UNKNOWN_MAPPED; i++) {
+        sprintf(unknown_keys[i], "m%d", i);
+        maps[i] = (JsonMap){unknown_keys[i], JC_OFFSET(unknown_record, mapped[i]), 'i', 0, true, NULL};
+    }
+    return compile_or_die(maps, UNKNOWN_MAPPED, true);
+}
+
+static void unknown_json(text* t) {
+    text_printf(t, "{");
+    int mapped = 0;
+    for (int i = 0; i < UNKNOWN_MAPPED + UNKNOWN_EXTRA; i++) {
+        if (i) text_printf(t, ",");
+        if (i % 5 == 4 && mapped < UNKNOWN_MAPPED) {
+            text_printf(t, "\"m%d\":%d", mapped++, i);
+            continue;
+        }
+        switch (i % 4) {
+            case 0:
+                text_printf(t, "\"x%d\":{\"id\":%d,\"tags\":[\"a]\",\"b{\"],\"geo\":{\"lat\":1.5,\"lon\":-2.25}}", i, i);
+                break;
+            case 1:
+                text_printf(t, "\"x%d\":[1,2,3,[4,5,[6]],{\"k\":\"v\"}]", i);
+                break;
+            case 2:
+                text_printf(t, "\"x%d\":\"Mozilla/5.0 (X11; Linux x86_64) \\\"quoted\\\" {not json}\"", i);
+                break;
+            default:
+                text_printf(t, "\"x%d\":%d.25", i, i * 1000);
+                break;
+        }
+    }
+    while (mapped < UNKNOWN_MAPPED) {
+        text_printf(t, ",\"m%d\":%d", mapped, mapped);
+        mapped++;
+    }
+    text_printf(t, "}");
+}
+
+// Newline-delimited records with one unmapped field each
+typedef struct ndjson_record {
+    int64_t ts;
+    int id;
+    char level[8];
+    double value;
+} ndjson_record;
+
+static jc_schema* ndjson_schema(void) {
+    JsonMap maps[] = {
+        {"ts", JC_OFFSET(ndjson_record, ts), 'I', 0, true, NULL},
+        {"id", JC_OFFSET(ndjson_record, id), 'i', 0, true, NULL},
+        {"level", JC_OFFSET(ndjson_record, level), 's', 8, false, NULL},
+        {"value", JC_OFFSET(ndjson_record, value), 'd', 0, false, NULL}
+    };
+    return compile_or_die(maps, 4, true);
+}
+
+static void ndjson_json(text* t) {
+    static const char* levels[] = {"debug", "info", "warn", "error"};
+    for (int i = 0; i < NDJSON_RECORDS; i++) {
+        text_printf(t, "{\"ts\":%lld,\"id\":%d,\"level\":\"%s\",\"value\":%.6f,\"host\":\"node-%d\"}\n",
+                    1700000000000LL + i * 17, i, levels[rng_next() % 4],
+                    (double)(rng_next() % 1000000) / 1000.0, (int)(rng_next() % 64));
+    }
+}
+
+// Run a benchmark n times; returns false if any parse fails
+static bool run_case(bench_case* c, size_t n) {
+    char* error = NULL;
+    for (size_t i = 0; i < n; i++) {
+        switch (c->mode) {
+            case MODE_PARSE:
+                if (c->opts.arena) jc_arena_reset(c->opts.arena);
+                if (!parse_json_ex(c->schema, c->base, c->json, c->len, &c->opts, &error)) {
+                    fprintf(stderr, "bench: %s failed: %s\n", c->name, error);
+                    return false;
+                }
+                break;
+            case MODE_NDJSON:
+                if (jc_parse_ndjson(c->schema, c->json, c->len, c->base, c->stride, c->docs, NULL) != c->docs) {
+                    fprintf(stderr, "bench: %s failed\n", c->name);
+                    return false;
+                }
+                break;
+            case MODE_DOC: {
+                jc_doc doc;
+                jc_arena_reset(c->opts.arena);
+                if (!jc_doc_parse(&doc, c->json, c->len, c->opts.arena, &error)) {
+                    fprintf(stderr, "bench: %s failed: %s\n", c->name, error);
+                    return false;
+                }
+                break;
+            }
+            case MODE_VALIDATE:
+                if (!jc_validate(c->schema, c->json, c->len, &error)) {
+                    fprintf(stderr, "bench: %s failed: %s\n", c->name, error);
+                    return false;
+                }
+                break;
+            case MODE_SERIALIZE:
+                c->out.len = 0;
+                if (!jc_serialize_buffer(c->schema, c->base, &c->out)) {
+                    fprintf(stderr, "bench: %s failed\n", c->name);
+                    return false;
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+#if defined(BENCH_HAVE_PERF)
+static int perf_open(uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+// Run n iterations under hardware counters, where the kernel allows it
+static bench_counters measure_counters(bench_case* c, size_t n) {
+    bench_counters result = {false, 0, 0, 0};
+#if defined(BENCH_HAVE_PERF)
+    static const uint64_t configs[3] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int fds[3];
+    for (int i = 0; i < 3; i++) {
+        fds[i] = perf_open(configs[i]);
+        if (fds[i] < 0) {
+            for (int j = 0; j < i; j++) close(fds[j]);
+            return result;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    bool ok = run_case(c, n);
+    uint64_t values[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++) {
+        ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fds[i], &values[i], sizeof(values[i])) != (ssize_t)sizeof(values[i])) ok = false;
+        close(fds[i]);
+    }
+    result.valid = ok;
+    result.cycles = values[0];
+    result.instructions = values[1];
+    result.branch_misses = values[2];
+#else
+    (void)c;
+    (void)n;
+#endif
+    return result;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Time one benchmark and print its result line
+static void bench_run(bench_case* c, const bench_settings* settings) {
+    if (settings->filter && !strstr(c->name, settings->filter)) return;
+
+    // Warm up, then count allocations of a single steady-state iteration
+    if (!run_case(c, 1)) return;
+    size_t before = alloc_count;
+    if (!run_case(c, 1)) return;
+    size_t allocs = alloc_count - before;
+
+    // Size each run to roughly the target duration
+    size_t iterations = 1;
+    for (;;) {
+        double start = now_seconds();
+        if (!run_case(c, iterations)) return;
+        double elapsed = now_seconds() - start;
+        if (elapsed >= settings->run_seconds / 4 || iterations >= ((size_t)1 << 30)) {
+            double scale = elapsed > 0 ? settings->run_seconds / elapsed : 2;
+            if (scale > 1) iterations = (size_t)((double)iterations * scale) + 1;
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double times[16];
+    int runs = settings->runs < 16 ? settings->runs : 16;
+    for (int r = 0; r < runs; r++) {
+        double start = now_seconds();
+        if (!run_case(c, iterations)) return;
+        times[r] = (now_seconds() - start) / (double)iterations;
+    }
+    qsort(times, (size_t)runs, sizeof(double), compare_doubles);
+    double per_run = times[runs / 2];
+    double spread = (times[runs - 1] - times[0]) / per_run;
+
+    size_t bytes = c->mode == MODE_SERIALIZE ? c->out.len : c->len;
+    fprintf(settings->out,
+            "{\"bench\":\"%s\",\"bytes\":%zu,\"docs\":%zu,\"fields\":%zu,\"iterations\":%zu,"
+            "\"mb_per_s\":%.1f,\"docs_per_s\":%.0f,\"ns_per_field\":%.2f,\"allocs_per_parse\":%zu,"
+            "\"spread\":%.3f",
+            c->name, bytes, c->docs, c->fields, iterations,
+            (double)bytes / per_run / 1e6, (double)c->docs / per_run,
+            per_run * 1e9 / (double)c->fields, allocs, spread);
+
+    if (settings->perf) {
+        bench_counters counters = measure_counters(c, iterations);
+        if (counters.valid) {
+            double n = (double)iterations;
+            fprintf(settings->out, ",\"cycles_per_byte\":%.3f,\"ipc\":%.2f,\"branch_misses_per_doc\":%.2f",
+                    (double)counters.cycles / n / (double)bytes,
+                    counters.cycles ? (double)counters.instructions / (double)counters.cycles : 0.0,
+                    (double)counters.branch_misses / n / (double)c->docs);
+        } else {
+            fprintf(settings->out, ",\"cycles_per_byte\":null,\"ipc\":null,\"branch_misses_per_doc\":null");
+        }
+    }
+    fprintf(settings->out, "}\n");
+    fflush(settings->out);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--quick] [--perf] [--filter NAME] [--time SECONDS] [--runs N] [--out FILE]\n"
+            "  --quick      Short runs, for smoke testing\n"
+            "  --perf       Add cycle, instruction and branch-miss counters (Linux)\n"
+            "  --filter     Only run benchmarks whose name contains NAME\n"
+            "  --time       Target duration of each timed run (default 0.2)\n"
+            "  --runs       Timed runs per benchmark; the median is reported (default 5)\n"
+            "  --out        Write results to FILE instead of stdout\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    bench_settings settings = {0.2, 5, false, NULL, stdout};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            settings.run_seconds = 0.02;
+            settings.runs = 3;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            settings.perf = true;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            settings.filter = argv[++i];
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            settings.run_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            settings.runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            settings.out = fopen(argv[++i], "w");
+            if (!settings.out) {
+                fprintf(stderr, "bench: cannot open %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (settings.runs < 1) settings.runs = 1;
+    if (settings.run_seconds <= 0) settings.run_seconds = 0.2;
+
+    static flat_record flat;
+    static unknown_record unknown;
+    static array_record arrays;
+    static ndjson_record records[NDJSON_RECORDS];
+    static char arena_memory[INT_VALUES * sizeof(int) * 2];
+    jc_arena arena;
+    jc_arena_init(&arena, arena_memory, sizeof(arena_memory));
+    static char tape_memory[1 << 22];
+    jc_arena tape_arena;
+    jc_arena_init(&tape_arena, tape_memory, sizeof(tape_memory));
+    jc_index index = {0};
+    jc_intern table = {0};
+
+    text flat_min = {0}, flat_pretty = {0}, deep = {0}, ints = {0}, strings = {0}, extra = {0}, lines = {0};
+    jc_schema* flat_sc = flat_schema();
+    flat_json(&flat_min, false);
+    flat_json(&flat_pretty, true);
+    jc_schema* predicted_sc = flat_schema();
+    char* error = NULL;
+    if (!jc_schema_predict(predicted_sc, &error)) {
+        fprintf(stderr, "prediction: %s\n", error);
+        return 1;
+    }
+    jc_schema* deep_sc = deep_schema();
+    deep_json(&deep);
+    jc_schema* int_sc = int_array_schema();
+    int_array_json(&ints);
+    jc_schema* string_sc = string_array_schema();
+    jc_schema* interned_sc = interned_array_schema();
+    string_array_json(&strings);
+    jc_schema* unknown_sc = unknown_schema();
+    unknown_json(&extra);
+    jc_schema* ndjson_sc = ndjson_schema();
+    ndjson_json(&lines);
+
+    bench_case cases[] = {
+        {"flat_minified", MODE_PARSE, flat_min.data, flat_min.len, 1, 4 * FLAT_FIELDS, flat_sc, &flat,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"flat_pretty", MODE_PARSE, flat_pretty.data, flat_pretty.len, 1, 4 * FLAT_FIELDS, flat_sc, &flat,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"flat_predicted", MODE_PARSE, flat_min.data, flat_min.len, 1, 4 * FLAT_FIELDS, predicted_sc, &flat,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"deep_nesting", MODE_PARSE, deep.data, deep.len, 1, DEEP_LEVELS, deep_sc, NULL,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"int_array", MODE_PARSE, ints.data, ints.len, 1, INT_VALUES, int_sc, &arrays,
+         {NULL, &arena, NULL, NULL, false, NULL}, 0, {0}},
+        {"string_array", MODE_PARSE, strings.data, strings.len, 1, STRING_VALUES, string_sc, &arrays,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"interned_string_array", MODE_PARSE, strings.data, strings.len, 1, STRING_VALUES, interned_sc, &arrays,
+         {NULL, NULL, NULL, NULL, false, &table}, 0, {0}},
+        {"unknown_heavy", MODE_PARSE, extra.data, extra.len, 1, UNKNOWN_MAPPED + UNKNOWN_EXTRA, unknown_sc,
+         &unknown, {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"unknown_heavy_indexed", MODE_PARSE, extra.data, extra.len, 1, UNKNOWN_MAPPED + UNKNOWN_EXTRA,
+         unknown_sc, &unknown, {NULL, NULL, &index, NULL, false, NULL}, 0, {0}},
+        {"ndjson", MODE_NDJSON, lines.data, lines.len, NDJSON_RECORDS, NDJSON_RECORDS * 5, ndjson_sc, records,
+         {NULL, NULL, NULL, NULL, false, NULL}, sizeof(ndjson_record), {0}},
+        {"doc_flat", MODE_DOC, flat_min.data, flat_min.len, 1, 4 * FLAT_FIELDS, NULL, NULL,
+         {NULL, &tape_arena, NULL, NULL, false, NULL}, 0, {0}},
+        {"doc_unknown_heavy", MODE_DOC, extra.data, extra.len, 1, UNKNOWN_MAPPED + UNKNOWN_EXTRA, NULL, NULL,
+         {NULL, &tape_arena, NULL, NULL, false, NULL}, 0, {0}},
+        {"validate_flat", MODE_VALIDATE, flat_min.data, flat_min.len, 1, 4 * FLAT_FIELDS, flat_sc, NULL,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"validate_string_array", MODE_VALIDATE, strings.data, strings.len, 1, STRING_VALUES, string_sc, NULL,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"validate_unknown_heavy", MODE_VALIDATE, extra.data, extra.len, 1, UNKNOWN_MAPPED + UNKNOWN_EXTRA,
+         unknown_sc, NULL, {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+        {"serialize_flat", MODE_SERIALIZE, NULL, 0, 1, 4 * FLAT_FIELDS, flat_sc, &flat,
+         {NULL, NULL, NULL, NULL, false, NULL}, 0, {0}},
+    };
+
+    // The serializer writes the struct parsed from the flat corpus
+    parse_json_into_n(flat_sc, &flat, flat_min.data, flat_min.len, &error);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        bench_run(&cases[i], &settings);
+        jc_buffer_free(&cases[i].out);
+    }
+
+    jc_index_free(&index);
+    jc_intern_free(&table);
+    jc_schema_free(flat_sc);
+    jc_schema_free(predicted_sc);
+    jc_schema_free(deep_sc);
+    jc_schema_free(int_sc);
+    jc_schema_free(string_sc);
+    jc_schema_free(interned_sc);
+    jc_schema_free(unknown_sc);
+    jc_schema_free(ndjson_sc);
+    free(flat_min.data);
+    free(flat_pretty.data);
+    free(deep.data);
+    free(ints.data);
+    free(strings.data);
+    free(extra.data);
+    free(lines.data);
+    if (settings.out != stdout) fclose(settings.out);
+    return 0;
+}
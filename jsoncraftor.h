@@ -24,367 +24,7054 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <float.h>
+
+// Allocator hooks. Define all four before including this header to route
+// the library's allocations elsewhere.
+#ifndef JC_MALLOC
+#define JC_MALLOC(size) malloc(size)
+#define JC_CALLOC(count, size) calloc(count, size)
+#define JC_REALLOC(ptr, size) realloc(ptr, size)
+#define JC_FREE(ptr) free(ptr)
+#endif
+
+// Objects with up to this many mappings track found fields in a stack
+// bitmask; larger ones use a jc_scratch or, failing that, the heap.
+#ifndef JC_STACK_FIELDS
+#define JC_STACK_FIELDS 256
+#endif
+
+// Keys with escapes are decoded before matching when they are at most this
+// long; longer ones are matched as written.
+#ifndef JC_KEY_MAX
+#define JC_KEY_MAX 256
+#endif
+
+// Instrumentation hooks, compiled out unless defined before including this
+// header. JC_HOOK_BEGIN and JC_HOOK_END expand as statements in the same
+// block around each document parse, so BEGIN may declare locals that END
+// reads (e.g. a start timestamp for per-schema latency histograms).
+#ifndef JC_HOOK_BEGIN
+#define JC_HOOK_BEGIN(schema, json, len) ((void)0)
+#endif
+#ifndef JC_HOOK_END
+#define JC_HOOK_END(schema, stats, ok) ((void)0)
+#endif
+#ifndef JC_HOOK_FIELD
+#define JC_HOOK_FIELD(map) ((void)0)
+#endif
+#ifndef JC_HOOK_SKIP
+#define JC_HOOK_SKIP(key, key_len) ((void)0)
+#endif
+
+// SIMD scanning kernels are used where the compiler targets SSE2 or NEON;
+// AVX2 is picked at runtime on x86 when the CPU supports it. Define
+// JC_NO_SIMD before including this header to build only the portable
+// scalar code.
+#if !defined(JC_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JC_SIMD_SSE2 1
+#include <emmintrin.h>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define JC_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define JC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
 
 // Define the mapping between JSON key and struct member
 typedef struct JsonMap {
     const char* json_key;     // JSON key name
-    void* struct_member;      // Pointer to struct member
-    char type;               // 'i' for int, 's' for string, 'b' for bool, 'd' for double, 'o' for object, 'a' for array
+    void* struct_member;      // Pointer to struct member (array item templates: optional JC_STRIDE)
+    char type;               // 'i' for int, 'I' for int64_t, 'U' for uint64_t, 's' for string, 'b' for bool,
+                             // 'd' for double, 'f' for float, 'o' for object, 'a' for array,
+                             // 'v' for variable-length array (jc_array), 'S' for string view (jc_str),
+                             // 'c' for an array of objects stored as columns,
+                             // 'e' for an enum (int), 'n' for an interned string (const char*)
     size_t size;            // Size for strings/arrays, or number of mappings for objects
+                            // ('v': maximum element count, 0 for no limit; 'e': number of names)
     bool required;          // Whether this field is required
-    struct JsonMap* nested; // For nested objects or array items
+    struct JsonMap* nested; // For nested objects or array items ('e': the names, see JC_NAME)
 } JsonMap;
 
-// Skip whitespace and specific character
-static bool skip_char(const char** ptr, char c) {
-    while (**ptr && (**ptr == ' ' || **ptr == '\n' || **ptr == '\t' || **ptr == '\r')) (*ptr)++;
-    if (**ptr == c) {
-        (*ptr)++;
-        return true;
+// Store a member offset in JsonMap.struct_member for schemas compiled with
+// jc_schema_compile_offsets(), e.g. {"age", JC_OFFSET(Person, age), 'i', ...}
+#define JC_OFFSET(type, member) ((void*)offsetof(type, member))
+
+// Store the distance between array elements in an item template's
+// struct_member, e.g. {"item", JC_STRIDE(sizeof(Point)), 'o', 2, true, point_maps}.
+// Required for arrays of objects, whose item mappings hold member offsets
+// (JC_OFFSET) within one element; other types default to their own size.
+#define JC_STRIDE(bytes) ((void*)(uintptr_t)(bytes))
+
+// One name of an 'e' mapping's list; the field stores the index of the
+// name that matches the string, e.g. for {"status", &rec.status, 'e', 3,
+// true, statuses} with JsonMap statuses[] = {JC_NAME("active"),
+// JC_NAME("idle"), JC_NAME("gone")}, "idle" stores 1
+#define JC_NAME(name) {name, NULL, 0, 0, false, NULL}
+
+// Compiled, immutable form of a JsonMap tree. Built once with
+// jc_schema_compile() and then shared by every parse that uses it.
+typedef struct jc_schema {
+    JsonMap* maps;              // Private copy of the mappings
+    size_t count;               // Number of mappings
+    size_t* key_lens;           // Precomputed length of each json_key
+    uint16_t* slots;            // Hash table of mapping index + 1, 0 = empty
+    size_t slot_mask;           // Hash table size - 1 (power of two)
+    uint32_t seed;              // Hash seed chosen at compile time
+    bool perfect;               // True if no two keys share a slot
+    bool relative;              // struct_member holds offsets, not pointers
+    struct jc_schema** nested;  // Compiled schema for each 'o' mapping
+    JsonMap* items;             // Private copies of 'a', 'v' and 'c' item templates
+    char* keys;                 // Private copies of the key strings
+    uint64_t* required;         // Bitmask of required mappings
+    // Key-order prediction, set up by jc_schema_predict(): entry 0 holds the
+    // mapping expected first and entry i + 1 the one expected after mapping
+    // i, as index + 1 (0 = unknown). Parses share it through relaxed atomics.
+    _Atomic uint16_t* predict;
+    _Atomic uint64_t hits;      // Keys matched by prediction
+    _Atomic uint64_t misses;    // Keys that needed a full lookup
+} jc_schema;
+
+// Scratch memory reused across parses for the found-field flags of objects
+// with more than JC_STACK_FIELDS mappings. Zero-initialize it, pass it in
+// jc_options, and release it with jc_scratch_free(); it grows on first use
+// and is then reused without further allocation.
+typedef struct jc_scratch {
+    uint64_t* words;
+    size_t cap;                 // Capacity in words
+    size_t used;                // Words in use by open objects
+} jc_scratch;
+
+// Destination of a 'v' mapping: elements laid out like a fixed array,
+// stored in the arena passed to the parse
+typedef struct jc_array {
+    void* items;                // First element, or NULL when empty
+    size_t count;               // Number of elements
+} jc_array;
+
+// Destination of an 'S' mapping: a string left in place in the input
+// buffer, which must outlive it. ptr/len cover the body between the
+// quotes; when escaped is set it still holds JSON escapes, which
+// jc_str_decode() resolves on demand.
+typedef struct jc_str {
+    const char* ptr;            // First byte of the string body
+    size_t len;                 // Body length in bytes
+    bool escaped;               // Body contains backslash escapes
+} jc_str;
+
+// Caller-provided bump allocator for variable-length arrays. Elements stay
+// valid until the arena is reset, so reset it once per message rather
+// than freeing arrays one by one. The arena never allocates on its own.
+typedef struct jc_arena {
+    char* data;                 // Caller's memory
+    size_t cap;                 // Size of data in bytes
+    size_t used;                // Bytes handed out
+} jc_arena;
+
+// Use cap bytes at mem as an arena
+void jc_arena_init(jc_arena* arena, void* mem, size_t cap) {
+    arena->data = mem;
+    arena->cap = cap;
+    arena->used = 0;
+}
+
+// Release every array stored in the arena at once
+void jc_arena_reset(jc_arena* arena) {
+    arena->used = 0;
+}
+
+// Resize the block at ptr (size old_size, or NULL) to new_size bytes. The
+// most recent block is resized in place; others shrink in place or move to
+// a fresh block to grow. Returns NULL when the arena is full.
+static void* jc_arena_grow(jc_arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    char* block = ptr;
+    if (block && block + old_size == arena->data + arena->used) {
+        size_t start = (size_t)(block - arena->data);
+        if (new_size > arena->cap - start) return NULL;
+        arena->used = start + new_size;
+        return block;
+    }
+    if (block && new_size <= old_size) return block;
+
+    size_t align = _Alignof(max_align_t);
+    size_t start = arena->used + ((0 - (uintptr_t)(arena->data + arena->used)) & (align - 1));
+    if (start > arena->cap || new_size > arena->cap - start) return NULL;
+    arena->used = start + new_size;
+    if (block) memcpy(arena->data + start, block, old_size);
+    return arena->data + start;
+}
+
+// Table of interned strings shared by every parse given it: an 'n' mapping
+// stores a pointer to the table's copy of its string, so equal strings
+// store equal pointers and compare with ==. Zero-initialize it, pass it in
+// jc_options, and release it with jc_intern_free(); the strings stay put
+// until then, however much the table grows. Not safe to share between
+// threads parsing at once.
+typedef struct jc_intern_block {
+    struct jc_intern_block* next; // Previously filled block
+    size_t used;                // Bytes handed out
+    size_t cap;                 // Size of data in bytes
+    char data[];
+} jc_intern_block;
+
+typedef struct jc_intern_slot {
+    const char* str;            // Interned copy, NUL-terminated; NULL = empty
+    size_t len;                 // Its length
+    uint32_t hash;
+} jc_intern_slot;
+
+typedef struct jc_intern {
+    jc_intern_slot* slots;      // Open-addressing hash table
+    size_t slot_mask;           // Table size - 1 (power of two), 0 when unallocated
+    size_t count;               // Distinct strings interned
+    jc_intern_block* blocks;    // Storage for the strings, newest first
+} jc_intern;
+
+// Structural index of a document: one entry per bracket outside strings,
+// in input order, holding its byte offset (low 32 bits) and the entry of
+// its partner bracket (high 32 bits). Zero-initialize it, pass it in
+// jc_options to skip unmapped objects and arrays in O(1), and release it
+// with jc_index_free(); the memory is reused across documents.
+typedef struct jc_index {
+    uint64_t* entries;
+    size_t count;               // Entries in use; 0 when unbuilt or unbalanced
+    size_t cap;                 // Capacity in entries
+} jc_index;
+
+// Counters filled in by a parse that asks for them in jc_options. On
+// failure, bytes is where parsing stopped and the error fields locate it.
+typedef struct jc_stats {
+    size_t bytes;               // Input consumed
+    size_t fields_matched;      // Keys stored through a mapping
+    size_t keys_skipped;        // Keys with no mapping whose values were skipped
+    size_t max_depth;           // Deepest nesting of parsed objects and arrays
+    size_t allocations;         // Heap allocations made by the parse
+    size_t error_offset;        // Byte offset of the error
+    size_t error_line;          // 1-based line of the error, or 0 on success
+    size_t error_column;        // 1-based byte column of the error, or 0 on success
+} jc_stats;
+
+// Optional settings for parse_json_ex()
+typedef struct jc_options {
+    jc_scratch* scratch;        // Memory for the flags of very wide objects
+    jc_arena* arena;            // Memory for 'v' arrays; required if the schema has any
+    jc_index* index;            // Built before parsing and used to skip unmapped values
+    jc_stats* stats;            // Filled in with counters for the parse, if set
+    bool stop_when_complete;    // Stop once every top-level mapping is filled, leaving the rest unread
+    jc_intern* intern;          // Table for 'n' strings; required if the schema has any
+} jc_options;
+
+// Per-parse state threaded through the parser
+typedef struct jc_ctx {
+    const char* end;    // One past the last input byte
+    char** error;       // Where to store the error message
+    jc_scratch* scratch; // Optional memory for wide objects' found flags
+    jc_arena* arena;    // Memory for variable-length arrays, if any
+    bool relative;      // Mappings without a schema hold offsets (array elements)
+    bool columnar;      // Next object is a row of a columnar array
+    size_t row;         // Index of that row
+    const jc_index* index; // Structural index of the input, if built
+    const char* start;  // First input byte, for index offsets
+    size_t cursor;      // First index entry not yet passed
+    size_t depth;       // Objects and arrays currently open
+    size_t max_depth;   // Deepest nesting so far
+    size_t matched;     // Keys stored through a mapping
+    size_t skipped;     // Keys skipped for lack of a mapping
+    size_t allocations; // Heap allocations made so far
+    bool stop_when_complete; // End the top-level object once every mapping is found
+    bool stopped;       // The document was left before its end
+    char* key;          // JC_KEY_MAX bytes for decoding keys with escapes
+    jc_intern* intern;  // Table for interned strings, if any
+} jc_ctx;
+
+// Context for parsing [start, end) with every other field zeroed
+static inline jc_ctx jc_ctx_init(const char* end, char** error, const char* start) {
+    jc_ctx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.end = end;
+    ctx.error = error;
+    ctx.start = start;
+    return ctx;
+}
+
+// Found-field flags for one object being parsed
+typedef struct jc_bits {
+    uint64_t* heap;             // Heap words when there is no scratch
+    jc_scratch* scratch;        // Scratch holding the words, if used
+    size_t mark;                // Offset of the words in the scratch
+    uint64_t stack[JC_STACK_FIELDS / 64];
+} jc_bits;
+
+// Prepare zeroed flags for count fields without touching the heap when
+// the stack or the scratch has room; heap allocations are added to allocations
+static bool jc_bits_init(jc_bits* bits, size_t count, jc_scratch* scratch, size_t* allocations) {
+    size_t words = (count + 63) / 64;
+    bits->heap = NULL;
+    bits->scratch = NULL;
+    if (words <= JC_STACK_FIELDS / 64) {
+        memset(bits->stack, 0, words * sizeof(uint64_t));
+        return true;
+    }
+    if (scratch) {
+        if (scratch->used + words > scratch->cap) {
+            size_t cap = scratch->cap * 2 > scratch->used + words ? scratch->cap * 2 : scratch->used + words;
+            uint64_t* grown = JC_REALLOC(scratch->words, cap * sizeof(uint64_t));
+            if (!grown) return false;
+            (*allocations)++;
+            scratch->words = grown;
+            scratch->cap = cap;
+        }
+        bits->scratch = scratch;
+        bits->mark = scratch->used;
+        scratch->used += words;
+        memset(scratch->words + bits->mark, 0, words * sizeof(uint64_t));
+        return true;
+    }
+    bits->heap = JC_CALLOC(words, sizeof(uint64_t));
+    if (!bits->heap) return false;
+    (*allocations)++;
+    return true;
+}
+
+// Current location of the flags; scratch words may move as it grows
+static inline uint64_t* jc_bits_words(jc_bits* bits) {
+    if (bits->scratch) return bits->scratch->words + bits->mark;
+    return bits->heap ? bits->heap : bits->stack;
+}
+
+static void jc_bits_release(jc_bits* bits) {
+    if (bits->scratch) bits->scratch->used = bits->mark;
+    JC_FREE(bits->heap);
+}
+
+// Release memory held by a jc_scratch
+void jc_scratch_free(jc_scratch* scratch) {
+    JC_FREE(scratch->words);
+    scratch->words = NULL;
+    scratch->cap = 0;
+    scratch->used = 0;
+}
+
+static inline bool jc_is_ws(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+static inline unsigned jc_ctz(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(mask);
+#else
+    unsigned n = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+#if defined(JC_SIMD_SSE2)
+// Offset of the first non-whitespace byte in a 16-byte block, or 16
+static inline unsigned jc_sse2_non_ws(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                           _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+                              _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')),
+                                           _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    uint32_t mask = ~(uint32_t)_mm_movemask_epi8(ws) & 0xFFFFu;
+    return mask ? jc_ctz(mask) : 16;
+}
+
+// Offset of the first '"' or '\\' in a 16-byte block, or 16
+static inline unsigned jc_sse2_quote(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                               _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+    return mask ? jc_ctz(mask) : 16;
+}
+
+// Offset of the first '"', '\\', control or non-ASCII byte in a 16-byte
+// block, or 16. The signed compare catches bytes >= 0x80 with those < 0x20.
+static inline unsigned jc_sse2_special(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                            _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                               _mm_cmplt_epi8(v, _mm_set1_epi8(0x20)));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+    return mask ? jc_ctz(mask) : 16;
+}
+#endif
+
+#if defined(JC_SIMD_AVX2)
+__attribute__((target("avx2")))
+static const char* jc_avx2_skip_ws(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                                     _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')),
+                                                     _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(ws);
+        if (mask) return p + jc_ctz(mask);
+        p += 32;
+    }
+    return p;
+}
+
+__attribute__((target("avx2")))
+static const char* jc_avx2_scan_quote(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+        if (mask) return p + jc_ctz(mask);
+        p += 32;
+    }
+    return p;
+}
+
+__attribute__((target("avx2")))
+static const char* jc_avx2_scan_special(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                                                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), v));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+        if (mask) return p + jc_ctz(mask);
+        p += 32;
+    }
+    return p;
+}
+
+static inline bool jc_have_avx2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#if defined(JC_SIMD_NEON)
+// Nibble mask with 4 bits per byte lane of a comparison result
+static inline uint64_t jc_neon_mask(uint8x16_t cmp) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+}
+
+static inline unsigned jc_neon_first(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(mask) >> 2;
+#else
+    unsigned n = 0;
+    while (!(mask & 0xF)) {
+        mask >>= 4;
+        n++;
+    }
+    return n;
+#endif
+}
+#endif
+
+// Return the first non-whitespace byte in [p, end), or end
+static inline const char* jc_skip_ws(const char* p, const char* end) {
+    // Minified input rarely has whitespace, so check one byte first
+    if (p >= end || !jc_is_ws(*p)) return p;
+    p++;
+#if defined(JC_SIMD_AVX2)
+    if (end - p >= 32 && jc_have_avx2()) p = jc_avx2_skip_ws(p, end);
+#endif
+#if defined(JC_SIMD_SSE2)
+    while (end - p >= 16) {
+        unsigned off = jc_sse2_non_ws(p);
+        if (off < 16) return p + off;
+        p += 16;
+    }
+#elif defined(JC_SIMD_NEON)
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\n'))),
+                                 vorrq_u8(vceqq_u8(v, vdupq_n_u8('\t')), vceqq_u8(v, vdupq_n_u8('\r'))));
+        uint64_t mask = ~jc_neon_mask(ws);
+        if (mask) return p + jc_neon_first(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && jc_is_ws(*p)) p++;
+    return p;
+}
+
+// Return the first '"' or '\\' in [p, end), or end
+static inline const char* jc_scan_quote(const char* p, const char* end) {
+#if defined(JC_SIMD_AVX2)
+    if (end - p >= 64 && jc_have_avx2()) p = jc_avx2_scan_quote(p, end);
+#endif
+#if defined(JC_SIMD_SSE2)
+    while (end - p >= 16) {
+        unsigned off = jc_sse2_quote(p);
+        if (off < 16) return p + off;
+        p += 16;
+    }
+#elif defined(JC_SIMD_NEON)
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\')));
+        uint64_t mask = jc_neon_mask(hit);
+        if (mask) return p + jc_neon_first(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') p++;
+    return p;
+}
+
+// Return the closing quote of a string whose body starts at p, or end.
+// Escaped characters are stepped over, not decoded.
+static inline const char* jc_find_string_end(const char* p, const char* end) {
+    for (;;) {
+        p = jc_scan_quote(p, end);
+        if (p >= end || *p == '"') return p;
+        p += 2;
+        if (p > end) return end;
+    }
+}
+
+// Return the first byte in [p, end) that a string validator must look at:
+// '"', '\\', a control character or a non-ASCII byte; or end
+static inline const char* jc_scan_special(const char* p, const char* end) {
+#if defined(JC_SIMD_AVX2)
+    if (end - p >= 64 && jc_have_avx2()) p = jc_avx2_scan_special(p, end);
+#endif
+#if defined(JC_SIMD_SSE2)
+    while (end - p >= 16) {
+        unsigned off = jc_sse2_special(p);
+        if (off < 16) return p + off;
+        p += 16;
+    }
+#elif defined(JC_SIMD_NEON)
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+                                  vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)), vcgeq_u8(v, vdupq_n_u8(0x80))));
+        uint64_t mask = jc_neon_mask(hit);
+        if (mask) return p + jc_neon_first(mask);
+        p += 16;
+    }
+#endif
+    while (p < end) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) break;
+        p++;
+    }
+    return p;
+}
+
+// Skip whitespace and specific character
+static bool skip_char(const char** ptr, const char* end, char c) {
+    *ptr = jc_skip_ws(*ptr, end);
+    if (*ptr < end && **ptr == c) {
+        (*ptr)++;
+        return true;
+    }
+    return false;
+}
+
+// Check if we've reached the end of input
+static bool is_end(const char* ptr, const char* end) {
+    return jc_skip_ws(ptr, end) == end;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define JC_SWAR 1
+#elif defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#define JC_SWAR 1
+#endif
+
+static inline bool jc_is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+#if defined(JC_SWAR)
+static inline uint64_t jc_load64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// True if all eight bytes of v are ASCII digits
+static inline bool jc_is_eight_digits(uint64_t v) {
+    return !(((v + 0x4646464646464646ULL) | (v - 0x3030303030303030ULL)) & 0x8080808080808080ULL);
+}
+
+// Convert eight ASCII digits (first digit in the low byte) to their value
+static inline uint32_t jc_eight_digits(uint64_t v) {
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+         (((v >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+    return (uint32_t)v;
+}
+#endif
+
+// Accumulate a run of digits into *value (wrapping) and return its end
+static inline const char* jc_scan_digits(const char* p, const char* end, uint64_t* value) {
+    uint64_t v = *value;
+#if defined(JC_SWAR)
+    while (end - p >= 8) {
+        uint64_t chunk = jc_load64(p);
+        if (!jc_is_eight_digits(chunk)) break;
+        v = v * 100000000ULL + jc_eight_digits(chunk);
+        p += 8;
+    }
+#endif
+    while (p < end && jc_is_digit(*p)) {
+        v = v * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    *value = v;
+    return p;
+}
+
+// Parse a JSON integer into sign and magnitude, rejecting fractions,
+// exponents and values that do not fit in 64 bits
+static bool jc_parse_integer(const char** ptr, const char* end, bool* negative,
+                             uint64_t* magnitude, char** error) {
+    const char* p = *ptr;
+    *negative = p < end && *p == '-';
+    if (*negative) p++;
+
+    const char* digits = p;
+    uint64_t value = 0;
+    if (p < end && *p == '0') {
+        p++;
+    } else {
+        p = jc_scan_digits(p, end, &value);
+    }
+    size_t count = p - digits;
+    if (count == 0 || (p < end && (jc_is_digit(*p) || *p == '.' || *p == 'e' || *p == 'E'))) {
+        *error = "Invalid integer value";
+        return false;
+    }
+
+    // Up to 19 digits always fit; a 20-digit value must not have wrapped
+    if (count > 20 || (count == 20 && (digits[0] > '1' || value < 10000000000000000000ULL))) {
+        *error = "Integer out of range";
+        return false;
+    }
+
+    *magnitude = value;
+    *ptr = p;
+    return true;
+}
+
+// Binary floating-point format parameters for decimal conversion
+typedef struct jc_float_format {
+    int mantissa_bits;          // Explicit mantissa bits
+    int minimum_exponent;       // Exponent bias, negated
+    int infinite_power;         // Biased exponent of infinity
+    int smallest_power_of_ten;  // Below this, values round to zero
+    int largest_power_of_ten;   // Above this, values round to infinity
+    int min_round_to_even;      // Range where ties to even can occur
+    int max_round_to_even;
+    int max_fast_exponent;      // Exact powers of ten for the fast path
+    uint64_t max_fast_mantissa; // Exactly representable mantissas
+} jc_float_format;
+
+static const jc_float_format jc_binary64 = {52, -1023, 0x7FF, -342, 308, -4, 23, 22, 1ULL << 53};
+static const jc_float_format jc_binary32 = {23, -127, 0xFF, -65, 38, -17, 10, 10, 1ULL << 24};
+
+// Decimal number as scanned from the input: w * 10^q
+typedef struct jc_decimal {
+    const char* start;          // First byte of the number text
+    const char* end;            // One past the last byte
+    uint64_t w;                 // Up to 19 significant digits
+    int64_t q;                  // Decimal exponent
+    bool negative;
+    bool truncated;             // Non-zero digits were dropped from w
+} jc_decimal;
+
+// Scan a JSON number into a decimal mantissa and exponent
+static bool jc_scan_decimal(const char** ptr, const char* end, jc_decimal* dec) {
+    const char* p = *ptr;
+    dec->start = p;
+    dec->negative = p < end && *p == '-';
+    if (dec->negative) p++;
+
+    uint64_t w = 0;
+    const char* int_start = p;
+    if (p < end && *p == '0') {
+        p++;
+    } else {
+        p = jc_scan_digits(p, end, &w);
+    }
+    const char* int_end = p;
+    if (int_end == int_start || (p < end && jc_is_digit(*p))) return false;
+
+    const char* frac_start = p;
+    const char* frac_end = p;
+    if (p < end && *p == '.') {
+        frac_start = ++p;
+        p = jc_scan_digits(p, end, &w);
+        frac_end = p;
+        if (frac_end == frac_start) return false;
+    }
+
+    int64_t exponent = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_negative = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            exp_negative = *p == '-';
+            p++;
+        }
+        if (p >= end || !jc_is_digit(*p)) return false;
+        while (p < end && jc_is_digit(*p)) {
+            if (exponent < 0x10000000) exponent = exponent * 10 + (*p - '0');
+            p++;
+        }
+        if (exp_negative) exponent = -exponent;
+    }
+
+    dec->w = w;
+    dec->q = exponent - (frac_end - frac_start);
+    dec->truncated = false;
+
+    // More than 19 digits: keep the first 19 significant ones
+    if ((int_end - int_start) + (frac_end - frac_start) > 19) {
+        w = 0;
+        int taken = 0;
+        int64_t shift = 0;
+        for (const char* d = int_start; d < frac_end; d++) {
+            if (*d == '.') continue;
+            bool in_int = d < int_end;
+            if (taken == 0 && *d == '0') {
+                // Leading zeros only move the exponent
+                if (!in_int) shift--;
+            } else if (taken < 19) {
+                w = w * 10 + (uint64_t)(*d - '0');
+                taken++;
+                if (!in_int) shift--;
+            } else {
+                if (in_int) shift++;
+                if (*d != '0') dec->truncated = true;
+            }
+        }
+        dec->w = w;
+        dec->q = exponent + shift;
+    }
+
+    dec->end = p;
+    *ptr = p;
+    return true;
+}
+
+// Most significant 128 bits of 5^q for q in [-342, 308], used to multiply a
+// decimal mantissa by a power of ten (Eisel-Lemire)
+static const uint64_t jc_power_of_five_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL,
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL,
+    0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL,
+    0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL,
+    0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL,
+    0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+    0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL,
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL,
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+    0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL,
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+};
+
+typedef struct jc_u128 {
+    uint64_t low;
+    uint64_t high;
+} jc_u128;
+
+static inline jc_u128 jc_mul64(uint64_t a, uint64_t b) {
+    jc_u128 r;
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)a * b;
+    r.low = (uint64_t)p;
+    r.high = (uint64_t)(p >> 64);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    r.high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    r.low = (cross << 32) | (uint32_t)lo_lo;
+#endif
+    return r;
+}
+
+static inline int jc_clz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    while (!(v & 0x8000000000000000ULL)) {
+        v <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Convert w * 10^q (w != 0) to the bits of a binary float with the
+// Eisel-Lemire algorithm. Returns false in the rare cases where the 128-bit
+// approximation cannot decide the rounding.
+static bool jc_eisel_lemire(uint64_t w, int64_t q, const jc_float_format* fmt, uint64_t* bits) {
+    int mbits = fmt->mantissa_bits;
+    if (q < fmt->smallest_power_of_ten) {
+        *bits = 0;
+        return true;
+    }
+    if (q > fmt->largest_power_of_ten) {
+        *bits = (uint64_t)fmt->infinite_power << mbits;
+        return true;
+    }
+
+    int lz = jc_clz64(w);
+    w <<= lz;
+
+    size_t index = 2 * (size_t)(q + 342);
+    jc_u128 product = jc_mul64(w, jc_power_of_five_128[index]);
+    uint64_t precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (mbits + 3);
+    if ((product.high & precision_mask) == precision_mask) {
+        jc_u128 second = jc_mul64(w, jc_power_of_five_128[index + 1]);
+        product.low += second.high;
+        if (second.high > product.low) product.high++;
+    }
+    if (product.low == 0xFFFFFFFFFFFFFFFFULL && (q < -27 || q > 55)) {
+        return false;
+    }
+
+    int upperbit = (int)(product.high >> 63);
+    int shift = upperbit + 64 - mbits - 3;
+    uint64_t mantissa = product.high >> shift;
+    int32_t power2 = (int32_t)(((152170 + 65536) * q) >> 16) + 63 + upperbit - lz - fmt->minimum_exponent;
+
+    // Subnormal or zero
+    if (power2 <= 0) {
+        if (-power2 + 1 >= 64) {
+            *bits = 0;
+            return true;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = (mantissa < (1ULL << mbits)) ? 0 : 1;
+        *bits = (mantissa & ((1ULL << mbits) - 1)) | ((uint64_t)power2 << mbits);
+        return true;
+    }
+
+    // Exactly halfway between two floats: round to even
+    if (product.low <= 1 && q >= fmt->min_round_to_even && q <= fmt->max_round_to_even &&
+        (mantissa & 3) == 1 && (mantissa << shift) == product.high) {
+        mantissa &= ~1ULL;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << mbits)) {
+        mantissa = 1ULL << mbits;
+        power2++;
+    }
+    mantissa &= ~(1ULL << mbits);
+    if (power2 >= fmt->infinite_power) {
+        power2 = fmt->infinite_power;
+        mantissa = 0;
+    }
+    *bits = mantissa | ((uint64_t)power2 << mbits);
+    return true;
+}
+
+#ifndef JC_BIG_DECIMAL_DIGITS
+#define JC_BIG_DECIMAL_DIGITS 800   // Enough to round any double exactly
+#endif
+
+// Decimal of up to JC_BIG_DECIMAL_DIGITS digits for the slow path:
+// 0.d[0]d[1]... * 10^point, without trailing zeros
+typedef struct jc_big_decimal {
+    uint32_t count;
+    int32_t point;
+    bool truncated;             // Non-zero digits were dropped from d
+    uint8_t d[JC_BIG_DECIMAL_DIGITS];
+} jc_big_decimal;
+
+static void jc_big_decimal_trim(jc_big_decimal* b) {
+    while (b->count > 0 && b->d[b->count - 1] == 0) b->count--;
+    if (b->count == 0) b->point = 0;
+}
+
+// Read the digits and exponent of a scanned number
+static void jc_big_decimal_init(jc_big_decimal* b, const jc_decimal* dec) {
+    b->count = 0;
+    b->point = 0;
+    b->truncated = false;
+    const char* p = dec->start;
+    if (*p == '-') p++;
+    bool seen_point = false;
+    for (; p < dec->end && (jc_is_digit(*p) || *p == '.'); p++) {
+        if (*p == '.') {
+            seen_point = true;
+            continue;
+        }
+        if (b->count == 0 && *p == '0') {
+            // Leading zeros only move the point
+            if (seen_point) b->point--;
+            continue;
+        }
+        if (!seen_point) b->point++;
+        if (b->count < JC_BIG_DECIMAL_DIGITS) {
+            b->d[b->count++] = (uint8_t)(*p - '0');
+        } else if (*p != '0') {
+            b->truncated = true;
+        }
+    }
+    if (p < dec->end) {
+        // Exponent, clamped far beyond any finite value
+        p++;
+        bool negative = *p == '-';
+        if (*p == '+' || *p == '-') p++;
+        int32_t exponent = 0;
+        for (; p < dec->end; p++) {
+            if (exponent < 100000) exponent = exponent * 10 + (*p - '0');
+        }
+        b->point += negative ? -exponent : exponent;
+    }
+    jc_big_decimal_trim(b);
+}
+
+// Multiply by 2^k, k <= 60
+static void jc_big_decimal_shl(jc_big_decimal* b, int k) {
+    uint8_t digits[JC_BIG_DECIMAL_DIGITS + 20];
+    size_t w = sizeof(digits);
+    uint64_t n = 0;
+    for (size_t r = b->count; r-- > 0;) {
+        n += (uint64_t)b->d[r] << k;
+        digits[--w] = (uint8_t)(n % 10);
+        n /= 10;
+    }
+    while (n > 0) {
+        digits[--w] = (uint8_t)(n % 10);
+        n /= 10;
+    }
+    size_t count = sizeof(digits) - w;
+    b->point += (int32_t)(count - b->count);
+    if (count > JC_BIG_DECIMAL_DIGITS) {
+        for (size_t i = w + JC_BIG_DECIMAL_DIGITS; i < sizeof(digits); i++) {
+            if (digits[i]) b->truncated = true;
+        }
+        count = JC_BIG_DECIMAL_DIGITS;
+    }
+    memcpy(b->d, digits + w, count);
+    b->count = (uint32_t)count;
+    jc_big_decimal_trim(b);
+}
+
+// Divide by 2^k, k <= 60
+static void jc_big_decimal_shr(jc_big_decimal* b, int k) {
+    size_t r = 0, w = 0;
+    uint64_t n = 0;
+    // Take enough leading digits for the first quotient digit
+    while ((n >> k) == 0) {
+        if (r < b->count) {
+            n = n * 10 + b->d[r];
+        } else if (n == 0) {
+            b->count = 0;
+            b->point = 0;
+            return;
+        } else {
+            n *= 10;
+        }
+        r++;
+    }
+    b->point -= (int32_t)(r - 1);
+    uint64_t mask = (1ULL << k) - 1;
+    for (; r < b->count; r++) {
+        b->d[w++] = (uint8_t)(n >> k);
+        n = (n & mask) * 10 + b->d[r];
+    }
+    while (n > 0) {
+        uint8_t digit = (uint8_t)(n >> k);
+        if (w < JC_BIG_DECIMAL_DIGITS) {
+            b->d[w++] = digit;
+        } else if (digit) {
+            b->truncated = true;
+        }
+        n = (n & mask) * 10;
+    }
+    b->count = (uint32_t)w;
+    jc_big_decimal_trim(b);
+}
+
+static void jc_big_decimal_shift(jc_big_decimal* b, int k) {
+    for (; k > 60; k -= 60) jc_big_decimal_shl(b, 60);
+    for (; k < -60; k += 60) jc_big_decimal_shr(b, 60);
+    if (k > 0) jc_big_decimal_shl(b, k);
+    if (k < 0) jc_big_decimal_shr(b, -k);
+}
+
+// Integer part, rounded half to even (point <= 20)
+static uint64_t jc_big_decimal_round(const jc_big_decimal* b) {
+    uint64_t n = 0;
+    int32_t i = 0;
+    for (; i < b->point && i < (int32_t)b->count; i++) n = n * 10 + b->d[i];
+    for (; i < b->point; i++) n *= 10;
+    if (b->point >= 0 && b->point < (int32_t)b->count) {
+        uint8_t next = b->d[b->point];
+        bool up = next > 5;
+        if (next == 5) {
+            bool exact_half = b->point + 1 == (int32_t)b->count && !b->truncated;
+            up = !exact_half || (n & 1);
+        }
+        if (up) n++;
+    }
+    return n;
+}
+
+// Exact conversion of a scanned number for the rare inputs the fast paths
+// cannot round: the digits are scaled by powers of two into [1, 2) and the
+// mantissa bits read off with round-half-to-even. Needs no heap memory and
+// no locale.
+static uint64_t jc_big_decimal_to_bits(const jc_decimal* dec, const jc_float_format* fmt) {
+    static const uint8_t powers[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    int mbits = fmt->mantissa_bits;
+    uint64_t infinity = (uint64_t)fmt->infinite_power << mbits;
+    jc_big_decimal b;
+    jc_big_decimal_init(&b, dec);
+    if (b.count == 0 || b.point < -330) return 0;
+    if (b.point > 310) return infinity;
+
+    // Bring the value into [1/2, 1), keeping track of the power of two
+    int exp = 0;
+    while (b.point > 0) {
+        int n = b.point >= (int32_t)sizeof(powers) ? 27 : powers[b.point];
+        jc_big_decimal_shift(&b, -n);
+        exp += n;
+    }
+    while (b.point < 0 || (b.point == 0 && b.d[0] < 5)) {
+        int n = b.point == 0 ? 1 : -b.point >= (int32_t)sizeof(powers) ? 27 : powers[-b.point];
+        jc_big_decimal_shift(&b, n);
+        exp -= n;
+    }
+    exp--;
+
+    // Subnormals keep the minimum exponent and lose mantissa bits
+    int min_exp = fmt->minimum_exponent + 1;
+    if (exp < min_exp) {
+        jc_big_decimal_shift(&b, -(min_exp - exp));
+        exp = min_exp;
+    }
+    if (exp - fmt->minimum_exponent >= fmt->infinite_power) return infinity;
+
+    jc_big_decimal_shift(&b, mbits + 1);
+    uint64_t mantissa = jc_big_decimal_round(&b);
+    if (mantissa == (2ULL << mbits)) {
+        mantissa >>= 1;
+        exp++;
+        if (exp - fmt->minimum_exponent >= fmt->infinite_power) return infinity;
+    }
+    if (!(mantissa & (1ULL << mbits))) exp = fmt->minimum_exponent;
+    return (mantissa & ((1ULL << mbits) - 1)) | ((uint64_t)(exp - fmt->minimum_exponent) << mbits);
+}
+
+static const double jc_pow10_double[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const float jc_pow10_float[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// Clinger's fast path is exact only when arithmetic is done at the
+// precision of the target type
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define JC_FAST_PATH 1
+#endif
+
+// Convert a scanned decimal to the bits of a correctly rounded float
+static bool jc_decimal_to_bits(const jc_decimal* dec, const jc_float_format* fmt, uint64_t* bits) {
+    if (dec->w == 0) {
+        *bits = 0;
+        return true;
+    }
+    if (dec->truncated) {
+        // The true value lies between w and w + 1; both must round the same
+        uint64_t up;
+        if (!jc_eisel_lemire(dec->w, dec->q, fmt, bits) ||
+            !jc_eisel_lemire(dec->w + 1, dec->q, fmt, &up) || up != *bits) {
+            return false;
+        }
+        return true;
+    }
+    return jc_eisel_lemire(dec->w, dec->q, fmt, bits);
+}
+
+// Parse a JSON number into a correctly rounded double
+static bool jc_parse_double(const char** ptr, const char* end, double* out, char** error) {
+    jc_decimal dec;
+    if (!jc_scan_decimal(ptr, end, &dec)) {
+        *error = "Invalid double value";
+        return false;
+    }
+#if defined(JC_FAST_PATH)
+    if (!dec.truncated && dec.q >= -22 && dec.q <= 22 && dec.w <= jc_binary64.max_fast_mantissa) {
+        double val = (double)dec.w;
+        val = dec.q < 0 ? val / jc_pow10_double[-dec.q] : val * jc_pow10_double[dec.q];
+        *out = dec.negative ? -val : val;
+        return true;
+    }
+#endif
+    uint64_t bits;
+    if (!jc_decimal_to_bits(&dec, &jc_binary64, &bits)) bits = jc_big_decimal_to_bits(&dec, &jc_binary64);
+    if (dec.negative) bits |= 1ULL << 63;
+    memcpy(out, &bits, sizeof(*out));
+    return true;
+}
+
+// Parse a JSON number into a correctly rounded float
+static bool jc_parse_float(const char** ptr, const char* end, float* out, char** error) {
+    jc_decimal dec;
+    if (!jc_scan_decimal(ptr, end, &dec)) {
+        *error = "Invalid float value";
+        return false;
+    }
+#if defined(JC_FAST_PATH)
+    if (!dec.truncated && dec.q >= -10 && dec.q <= 10 && dec.w <= jc_binary32.max_fast_mantissa) {
+        float val = (float)dec.w;
+        val = dec.q < 0 ? val / jc_pow10_float[-dec.q] : val * jc_pow10_float[dec.q];
+        *out = dec.negative ? -val : val;
+        return true;
+    }
+#endif
+    uint64_t bits;
+    if (!jc_decimal_to_bits(&dec, &jc_binary32, &bits)) bits = jc_big_decimal_to_bits(&dec, &jc_binary32);
+    uint32_t bits32 = (uint32_t)bits;
+    if (dec.negative) bits32 |= 1u << 31;
+    memcpy(out, &bits32, sizeof(*out));
+    return true;
+}
+
+// Hash a key for schema lookup (FNV-1a with a per-schema seed)
+static uint32_t jc_hash_key(const char* key, size_t len, uint32_t seed) {
+    uint32_t h = seed ^ (uint32_t)len;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)key[i]) * 0x01000193u;
+    }
+    return h ^ (h >> 15);
+}
+
+// Find the mapping index for a key in a compiled schema, or -1
+static int jc_schema_find(const jc_schema* schema, const char* key, size_t len) {
+    size_t slot = jc_hash_key(key, len, schema->seed) & schema->slot_mask;
+    for (;;) {
+        size_t idx = schema->slots[slot];
+        if (idx == 0) return -1;
+        idx--;
+        if (schema->key_lens[idx] == len && memcmp(schema->maps[idx].json_key, key, len) == 0) {
+            return (int)idx;
+        }
+        if (schema->perfect) return -1;
+        slot = (slot + 1) & schema->slot_mask;
+    }
+}
+
+// Find the mapping index for a key by scanning the mappings, or -1
+static int find_mapping(const JsonMap* maps, size_t count, const char* key, size_t len) {
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(maps[i].json_key, key, len) == 0 && strlen(maps[i].json_key) == len) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Return the first '{', '}', '[', ']' or '"' in [p, end), or end
+static inline const char* jc_scan_structural(const char* p, const char* end) {
+#if defined(JC_SIMD_SSE2)
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        // '[' and ']' become '{' and '}' with bit 5 set
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                   _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                                _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+        if (mask) return p + jc_ctz(mask);
+        p += 16;
+    }
+#elif defined(JC_SIMD_NEON)
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t folded = vorrq_u8(v, vdupq_n_u8(0x20));
+        uint8x16_t hit = vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')),
+                                  vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))));
+        uint64_t mask = jc_neon_mask(hit);
+        if (mask) return p + jc_neon_first(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && (*p | 0x20) != '{' && (*p | 0x20) != '}') p++;
+    return p;
+}
+
+// Skip one value of any type: a string up to its closing quote, an object
+// or array up to its matching bracket (ignoring brackets inside strings),
+// and anything else up to the next delimiter
+static void skip_value(const char** ptr, const char* end) {
+    const char* p = jc_skip_ws(*ptr, end);
+    if (p < end && *p == '"') {
+        p = jc_find_string_end(p + 1, end);
+        *ptr = p < end ? p + 1 : end;
+        return;
+    }
+    if (p < end && (*p == '{' || *p == '[')) {
+        size_t depth = 0;
+        while (p < end) {
+            p = jc_scan_structural(p, end);
+            if (p >= end) break;
+            char c = *p;
+            if (c == '"') {
+                p = jc_find_string_end(p + 1, end);
+                if (p < end) p++;
+                continue;
+            }
+            p++;
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (--depth == 0) {
+                break;
+            }
+        }
+        *ptr = p;
+        return;
+    }
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && !jc_is_ws(*p)) p++;
+    *ptr = p;
+}
+
+// Bitmasks of one 64-byte block: bit i is set when byte i matches
+typedef struct jc_block {
+    uint64_t quote;             // '"'
+    uint64_t backslash;         // '\\'
+    uint64_t bracket;           // '{', '}', '[' or ']'
+} jc_block;
+
+#if defined(JC_SIMD_SSE2)
+static inline void jc_sse2_block(const char* p, jc_block* b) {
+    b->quote = b->backslash = b->bracket = 0;
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i bracket = _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                       _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+        b->quote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << (16 * i);
+        b->backslash |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << (16 * i);
+        b->bracket |= (uint64_t)(uint32_t)_mm_movemask_epi8(bracket) << (16 * i);
+    }
+}
+#endif
+
+#if defined(JC_SIMD_AVX2)
+__attribute__((target("avx2")))
+static void jc_avx2_block(const char* p, jc_block* b) {
+    b->quote = b->backslash = b->bracket = 0;
+    for (int i = 0; i < 2; i++) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + 32 * i));
+        __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i bracket = _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                                          _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}')));
+        b->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << (32 * i);
+        b->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << (32 * i);
+        b->bracket |= (uint64_t)(uint32_t)_mm256_movemask_epi8(bracket) << (32 * i);
+    }
+}
+#endif
+
+#if defined(JC_SIMD_NEON) && defined(__aarch64__)
+// Pack four 16-lane comparison results into a 64-bit mask
+static inline uint64_t jc_neon_bitmask(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d) {
+    const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(a, bits), vandq_u8(b, bits));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(c, bits), vandq_u8(d, bits));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static inline void jc_neon_block(const char* p, jc_block* b) {
+    uint8x16_t v[4], quote[4], backslash[4], bracket[4];
+    for (int i = 0; i < 4; i++) {
+        v[i] = vld1q_u8((const uint8_t*)p + 16 * i);
+        uint8x16_t folded = vorrq_u8(v[i], vdupq_n_u8(0x20));
+        quote[i] = vceqq_u8(v[i], vdupq_n_u8('"'));
+        backslash[i] = vceqq_u8(v[i], vdupq_n_u8('\\'));
+        bracket[i] = vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}')));
+    }
+    b->quote = jc_neon_bitmask(quote[0], quote[1], quote[2], quote[3]);
+    b->backslash = jc_neon_bitmask(backslash[0], backslash[1], backslash[2], backslash[3]);
+    b->bracket = jc_neon_bitmask(bracket[0], bracket[1], bracket[2], bracket[3]);
+}
+#endif
+
+static inline void jc_scalar_block(const char* p, jc_block* b) {
+    b->quote = b->backslash = b->bracket = 0;
+    for (int i = 0; i < 64; i++) {
+        char c = p[i];
+        uint64_t bit = 1ULL << i;
+        if (c == '"') b->quote |= bit;
+        else if (c == '\\') b->backslash |= bit;
+        else if ((c | 0x20) == '{' || (c | 0x20) == '}') b->bracket |= bit;
+    }
+}
+
+static inline size_t jc_popcount64(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(mask);
+#else
+    size_t n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+#endif
+}
+
+static inline unsigned jc_ctz64(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(mask);
+#else
+    unsigned n = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// State carried from one 64-byte block to the next
+typedef struct jc_stage1 {
+    uint64_t prev_escaped;      // First byte of the next block is escaped
+    uint64_t prev_in_string;    // All ones if the block ended inside a string
+    size_t open;                // Innermost unclosed bracket entry + 1, 0 = none
+    bool valid;                 // Brackets balanced so far
+} jc_stage1;
+
+// Mask of the bytes escaped by a backslash, given the backslash mask
+static inline uint64_t jc_escaped_mask(jc_stage1* st, uint64_t backslash) {
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    backslash &= ~st->prev_escaped;
+    uint64_t follows_escape = backslash << 1 | st->prev_escaped;
+    // Runs of backslashes escape every other byte; a run starting on an
+    // odd bit has the opposite parity
+    uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t even_runs = odd_starts + backslash;
+    st->prev_escaped = even_runs < backslash;
+    uint64_t invert = even_runs << 1;
+    return (even_bits ^ invert) & follows_escape;
+}
+
+// Mask of the bytes inside strings (opening quote included), from the
+// mask of unescaped quotes
+static inline uint64_t jc_string_mask(jc_stage1* st, uint64_t quote) {
+    uint64_t m = quote;
+    m ^= m << 1;
+    m ^= m << 2;
+    m ^= m << 4;
+    m ^= m << 8;
+    m ^= m << 16;
+    m ^= m << 32;
+    m ^= st->prev_in_string;
+    st->prev_in_string = (uint64_t)((int64_t)m >> 63);
+    return m;
+}
+
+// Add the brackets of one block to the index, pairing each closing bracket
+// with its opener. While open, an entry's partner links to the enclosing
+// open bracket.
+static bool jc_index_block(jc_index* index, jc_stage1* st, const char* json, size_t base,
+                           const jc_block* b) {
+    uint64_t escaped = jc_escaped_mask(st, b->backslash);
+    uint64_t in_string = jc_string_mask(st, b->quote & ~escaped);
+    uint64_t brackets = b->bracket & ~in_string;
+    size_t n = index->count + jc_popcount64(brackets);
+    if (n > index->cap) {
+        size_t cap = index->cap ? index->cap * 2 : 1024;
+        while (cap < n) cap *= 2;
+        uint64_t* entries = JC_REALLOC(index->entries, cap * sizeof(uint64_t));
+        if (!entries) return false;
+        index->entries = entries;
+        index->cap = cap;
+    }
+
+    while (brackets) {
+        size_t offset = base + jc_ctz64(brackets);
+        brackets &= brackets - 1;
+        size_t entry = index->count++;
+        char c = json[offset];
+        if (c == '{' || c == '[') {
+            index->entries[entry] = (uint64_t)offset | (uint64_t)st->open << 32;
+            st->open = entry + 1;
+            continue;
+        }
+        if (!st->open) {
+            st->valid = false;
+            continue;
+        }
+        size_t opener = st->open - 1;
+        uint64_t open_entry = index->entries[opener];
+        if ((json[(uint32_t)open_entry] == '{') != (c == '}')) st->valid = false;
+        st->open = (size_t)(open_entry >> 32);
+        index->entries[opener] = (uint32_t)open_entry | (uint64_t)entry << 32;
+        index->entries[entry] = (uint64_t)offset | (uint64_t)opener << 32;
+    }
+    return true;
+}
+
+// Build the structural index of len bytes of JSON: every bracket outside
+// strings, found 64 bytes at a time with SIMD, paired with its partner.
+// The index memory is kept for reuse by later builds. If the brackets do
+// not balance, the index is left empty and parsing falls back to scanning.
+bool jc_index_build(jc_index* index, const char* json, size_t len, char** error) {
+    index->count = 0;
+    if (len > UINT32_MAX) return true;
+
+    jc_stage1 st = {0, 0, 0, true};
+    jc_block b;
+    size_t base = 0;
+#if defined(JC_SIMD_AVX2)
+    bool avx2 = jc_have_avx2();
+#endif
+    for (; base + 64 <= len; base += 64) {
+#if defined(JC_SIMD_AVX2)
+        if (avx2) {
+            jc_avx2_block(json + base, &b);
+        } else
+#endif
+#if defined(JC_SIMD_SSE2)
+        jc_sse2_block(json + base, &b);
+#elif defined(JC_SIMD_NEON) && defined(__aarch64__)
+        jc_neon_block(json + base, &b);
+#else
+        jc_scalar_block(json + base, &b);
+#endif
+        if (!jc_index_block(index, &st, json, base, &b)) goto oom;
+    }
+    if (base < len) {
+        // Pad the last partial block with spaces
+        char tail[64];
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, json + base, len - base);
+        jc_scalar_block(tail, &b);
+        if (!jc_index_block(index, &st, json, base, &b)) goto oom;
+    }
+
+    if (!st.valid || st.open || st.prev_in_string) index->count = 0;
+    return true;
+
+oom:
+    index->count = 0;
+    *error = "Out of memory";
+    return false;
+}
+
+// Release the memory held by a jc_index
+void jc_index_free(jc_index* index) {
+    JC_FREE(index->entries);
+    index->entries = NULL;
+    index->count = 0;
+    index->cap = 0;
+}
+
+// Skip the value of an unmapped key. With a structural index, objects and
+// arrays are skipped by jumping straight past their closing bracket.
+static void jc_skip_unknown(jc_ctx* ctx, const char** ptr) {
+    *ptr = jc_skip_ws(*ptr, ctx->end);
+    const jc_index* index = ctx->index;
+    if (index && *ptr < ctx->end && (**ptr == '{' || **ptr == '[')) {
+        // Brackets are visited in input order, so the cursor only moves forward
+        uint32_t offset = (uint32_t)(*ptr - ctx->start);
+        size_t i = ctx->cursor;
+        while (i < index->count && (uint32_t)index->entries[i] < offset) i++;
+        ctx->cursor = i;
+        if (i < index->count && (uint32_t)index->entries[i] == offset) {
+            size_t close = (size_t)(index->entries[i] >> 32);
+            *ptr = ctx->start + (uint32_t)index->entries[close] + 1;
+            ctx->cursor = close + 1;
+            return;
+        }
+    }
+    skip_value(ptr, ctx->end);
+}
+
+// Append code point cp to out as UTF-8; returns the byte count
+static size_t jc_utf8_encode(uint32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Read the four hex digits of a \u escape
+static bool jc_parse_hex4(const char* p, const char* end, uint32_t* value) {
+    if (end - p < 4) return false;
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= (uint32_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= (uint32_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= (uint32_t)(c - 'A' + 10);
+        else return false;
+    }
+    *value = v;
+    return true;
+}
+
+// Length of the well-formed UTF-8 sequence starting at p, or 0. Overlong
+// forms, surrogates and code points past U+10FFFF are rejected.
+static inline size_t jc_utf8_sequence(const unsigned char* p, const unsigned char* end) {
+    unsigned char c = p[0];
+    size_t n;
+    unsigned char lo = 0x80, hi = 0xBF;   // Range of the second byte
+    if (c < 0xC2) return 0;
+    if (c < 0xE0) {
+        n = 2;
+    } else if (c < 0xF0) {
+        n = 3;
+        if (c == 0xE0) lo = 0xA0;
+        if (c == 0xED) hi = 0x9F;
+    } else if (c < 0xF5) {
+        n = 4;
+        if (c == 0xF0) lo = 0x90;
+        if (c == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    if ((size_t)(end - p) < n || p[1] < lo || p[1] > hi) return 0;
+    for (size_t i = 2; i < n; i++) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+    }
+    return n;
+}
+
+// Decode the escape at *ptr (a backslash with at least one byte after it)
+// into out, advancing *ptr past it. \uXXXX and surrogate pairs become
+// UTF-8. Returns the decoded length, or 0 on error.
+static size_t jc_decode_escape(const char** ptr, const char* end, char out[4], char** error) {
+    const char* p = *ptr;
+    char c = p[1];
+    p += 2;
+    size_t count = 1;
+    switch (c) {
+        case '"': out[0] = '"'; break;
+        case '\\': out[0] = '\\'; break;
+        case '/': out[0] = '/'; break;
+        case 'b': out[0] = '\b'; break;
+        case 'f': out[0] = '\f'; break;
+        case 'n': out[0] = '\n'; break;
+        case 'r': out[0] = '\r'; break;
+        case 't': out[0] = '\t'; break;
+        case 'u': {
+            uint32_t cp;
+            if (!jc_parse_hex4(p, end, &cp)) {
+                *error = "Invalid unicode escape";
+                return 0;
+            }
+            p += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                // High surrogate: must be followed by an escaped low one
+                uint32_t low;
+                if (end - p < 6 || p[0] != '\\' || p[1] != 'u' ||
+                    !jc_parse_hex4(p + 2, end, &low) || low < 0xDC00 || low > 0xDFFF) {
+                    *error = "Invalid unicode escape";
+                    return 0;
+                }
+                p += 6;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                *error = "Invalid unicode escape";
+                return 0;
+            }
+            count = jc_utf8_encode(cp, out);
+            break;
+        }
+        default:
+            *error = "Invalid escape sequence";
+            return 0;
+    }
+    *ptr = p;
+    return count;
+}
+
+// Decode the string body [p, end) into out, resolving escapes (\uXXXX and
+// surrogate pairs become UTF-8). out needs at most end - p bytes, since
+// no escape decodes to more bytes than it occupies. Stores the decoded
+// length in *out_len.
+static bool jc_unescape(const char* p, const char* end, char* out, size_t* out_len, char** error) {
+    char* o = out;
+    while (p < end) {
+        const char* run = jc_scan_quote(p, end);
+        memmove(o, p, (size_t)(run - p));
+        o += run - p;
+        p = run;
+        if (p >= end) break;
+        if (*p == '"' || end - p < 2) {
+            *error = "Invalid escape sequence";
+            return false;
+        }
+        size_t count = jc_decode_escape(&p, end, o, error);
+        if (!count) return false;
+        o += count;
+    }
+    *out_len = (size_t)(o - out);
+    return true;
+}
+
+// jc_scan_string() for bodies with escapes, non-ASCII or control bytes
+static bool jc_scan_string_slow(const char** ptr, const char* end, char* out, size_t cap, size_t* len,
+                                bool* escaped, char** error) {
+    const char* p = *ptr;
+    size_t n = 0;
+    *escaped = false;
+    for (;;) {
+        const char* run = jc_scan_special(p, end);
+        size_t run_len = (size_t)(run - p);
+        if (run_len >= cap - n) {
+            *error = "String too long";
+            return false;
+        }
+        if (out) memcpy(out + n, p, run_len);
+        n += run_len;
+        p = run;
+        if (p >= end) {
+            *error = "Unterminated string";
+            return false;
+        }
+
+        unsigned char c = (unsigned char)*p;
+        if (c == '"') break;
+        char decoded[4];
+        const char* bytes = decoded;
+        size_t count = 1;
+        if (c >= 0x80) {
+            count = jc_utf8_sequence((const unsigned char*)p, (const unsigned char*)end);
+            if (!count) {
+                *error = "Invalid UTF-8";
+                return false;
+            }
+            bytes = p;
+            p += count;
+        } else if (c < 0x20) {
+            *error = "Control character in string";
+            return false;
+        } else {
+            if (end - p < 2) {
+                *error = "Unterminated string";
+                return false;
+            }
+            *escaped = true;
+            count = jc_decode_escape(&p, end, decoded, error);
+            if (!count) return false;
+        }
+        if (count >= cap - n) {
+            *error = "String too long";
+            return false;
+        }
+        if (out) memcpy(out + n, bytes, count);
+        n += count;
+    }
+    *len = n;
+    *ptr = p + 1;
+    return true;
+}
+
+// Scan a string body from *ptr to just past its closing quote, checking
+// escapes (with \u surrogates paired), UTF-8 and control characters, and
+// copy the decoded text to out if it is set. The decoded length must stay
+// below cap; it is stored in *len. *escaped notes whether there were
+// escapes. Plain ASCII runs are found a vector at a time and copied whole.
+static inline bool jc_scan_string(const char** ptr, const char* end, char* out, size_t cap, size_t* len,
+                                  bool* escaped, char** error) {
+    // Most strings are plain ASCII up to the closing quote
+    const char* run = jc_scan_special(*ptr, end);
+    if (run < end && *run == '"') {
+        size_t n = (size_t)(run - *ptr);
+        if (n >= cap) {
+            *error = "String too long";
+            return false;
+        }
+        if (out) memcpy(out, *ptr, n);
+        *len = n;
+        *escaped = false;
+        *ptr = run + 1;
+        return true;
+    }
+    return jc_scan_string_slow(ptr, end, out, cap, len, escaped, error);
+}
+
+// Whether [p, end) is well-formed UTF-8; ASCII is skipped a vector at a time
+static bool jc_utf8_valid(const char* p, const char* end) {
+    for (;;) {
+        p = jc_scan_special(p, end);
+        if (p >= end) return true;
+        if ((unsigned char)*p < 0x80) {
+            p++;
+            continue;
+        }
+        size_t n = jc_utf8_sequence((const unsigned char*)p, (const unsigned char*)end);
+        if (!n) return false;
+        p += n;
+    }
+}
+
+// Decode a string view into out, which must hold str->len + 1 bytes, and
+// NUL-terminate it. Views without escapes are copied unchanged. Returns
+// false on a malformed escape.
+bool jc_str_decode(const jc_str* str, char* out, size_t* out_len, char** error) {
+    size_t len = str->len;
+    if (!str->escaped) {
+        if (len) memcpy(out, str->ptr, len);
+    } else if (!jc_unescape(str->ptr, str->ptr + str->len, out, &len, error)) {
+        return false;
+    }
+    out[len] = '\0';
+    if (out_len) *out_len = len;
+    return true;
+}
+
+// Find the slot holding a string, or the empty slot where it belongs
+static size_t jc_intern_slot_of(const jc_intern* table, const char* str, size_t len, uint32_t hash) {
+    size_t slot = hash & table->slot_mask;
+    for (;;) {
+        const jc_intern_slot* entry = &table->slots[slot];
+        if (!entry->str || (entry->hash == hash && entry->len == len && memcmp(entry->str, str, len) == 0)) {
+            return slot;
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+}
+
+// Double the hash table, or allocate its first 64 slots
+static bool jc_intern_rehash(jc_intern* table, size_t* allocations) {
+    size_t size = table->slots ? (table->slot_mask + 1) * 2 : 64;
+    jc_intern_slot* old = table->slots;
+    size_t old_size = old ? table->slot_mask + 1 : 0;
+    table->slots = JC_CALLOC(size, sizeof(jc_intern_slot));
+    if (!table->slots) {
+        table->slots = old;
+        return false;
+    }
+    if (allocations) (*allocations)++;
+    table->slot_mask = size - 1;
+    for (size_t i = 0; i < old_size; i++) {
+        if (old[i].str) table->slots[jc_intern_slot_of(table, old[i].str, old[i].len, old[i].hash)] = old[i];
+    }
+    JC_FREE(old);
+    return true;
+}
+
+// Intern len bytes at str, counting heap allocations; NULL when out of memory
+static const char* jc_intern_insert(jc_intern* table, const char* str, size_t len, size_t* allocations) {
+    uint32_t hash = jc_hash_key(str, len, 0);
+    if (table->slots) {
+        const jc_intern_slot* entry = &table->slots[jc_intern_slot_of(table, str, len, hash)];
+        if (entry->str) return entry->str;
+    }
+    // Keep the table at most three quarters full
+    if ((table->count + 1) * 4 > (table->slots ? table->slot_mask + 1 : 0) * 3 &&
+        !jc_intern_rehash(table, allocations)) {
+        return NULL;
+    }
+
+    jc_intern_block* block = table->blocks;
+    if (!block || len >= block->cap - block->used) {
+        size_t cap = len >= 4096 ? len + 1 : 4096;
+        block = JC_MALLOC(sizeof(jc_intern_block) + cap);
+        if (!block) return NULL;
+        if (allocations) (*allocations)++;
+        block->next = table->blocks;
+        block->used = 0;
+        block->cap = cap;
+        table->blocks = block;
+    }
+    char* copy = block->data + block->used;
+    if (len) memcpy(copy, str, len);
+    copy[len] = '\0';
+    block->used += len + 1;
+
+    jc_intern_slot* entry = &table->slots[jc_intern_slot_of(table, str, len, hash)];
+    entry->str = copy;
+    entry->len = len;
+    entry->hash = hash;
+    table->count++;
+    return copy;
+}
+
+// Return the table's copy of len bytes at str, adding it if new, e.g. to
+// compare 'n' fields against a known value with ==. NULL when out of memory.
+const char* jc_intern_add(jc_intern* table, const char* str, size_t len) {
+    return jc_intern_insert(table, str, len, NULL);
+}
+
+// Return the table's copy of len bytes at str, or NULL if it was never interned
+const char* jc_intern_find(const jc_intern* table, const char* str, size_t len) {
+    if (!table->slots) return NULL;
+    return table->slots[jc_intern_slot_of(table, str, len, jc_hash_key(str, len, 0))].str;
+}
+
+// Release a table and every string in it
+void jc_intern_free(jc_intern* table) {
+    while (table->blocks) {
+        jc_intern_block* next = table->blocks->next;
+        JC_FREE(table->blocks);
+        table->blocks = next;
+    }
+    JC_FREE(table->slots);
+    table->slots = NULL;
+    table->slot_mask = 0;
+    table->count = 0;
+}
+
+// Size of a value of the mapping's type, or 0 for objects and fixed arrays
+static size_t jc_type_size(const JsonMap* map) {
+    switch (map->type) {
+        case 'i': return sizeof(int);
+        case 'I': return sizeof(int64_t);
+        case 'U': return sizeof(uint64_t);
+        case 'd': return sizeof(double);
+        case 'f': return sizeof(float);
+        case 'b': return sizeof(bool);
+        case 's': return map->size;
+        case 'S': return sizeof(jc_str);
+        case 'v': return sizeof(jc_array);
+        case 'e': return sizeof(int);
+        case 'n': return sizeof(const char*);
+        default: return 0;
+    }
+}
+
+// Distance between elements of an array mapping: the item template's
+// explicit stride if set, otherwise the size of its type
+static size_t jc_item_size(const JsonMap* item_map) {
+    return item_map->struct_member ? (size_t)(uintptr_t)item_map->struct_member : jc_type_size(item_map);
+}
+
+static bool parse_object(jc_ctx* ctx, const char** ptr, const JsonMap* maps, size_t count,
+                         const jc_schema* schema, char* base, bool nested);
+static bool parse_value(jc_ctx* ctx, const char** ptr, const JsonMap* map, void* dst,
+                        const jc_schema* nested_schema);
+
+// Parse one array element at dst. Object elements hold member offsets,
+// which mappings without a compiled schema resolve against dst.
+static bool parse_item(jc_ctx* ctx, const char** ptr, const JsonMap* item_map, void* dst,
+                       const jc_schema* item_schema) {
+    bool relative = ctx->relative;
+    ctx->relative = true;
+    bool ok = parse_value(ctx, ptr, item_map, dst, item_schema);
+    ctx->relative = relative;
+    return ok;
+}
+
+// Parse one object of a columnar array: each field goes to element row of
+// the column at its offset in block
+static bool parse_row(jc_ctx* ctx, const char** ptr, const JsonMap* fields, size_t count,
+                      const jc_schema* schema, char* block, size_t row) {
+    bool relative = ctx->relative;
+    ctx->relative = true;
+    ctx->columnar = true;
+    ctx->row = row;
+    bool ok = parse_object(ctx, ptr, fields, count, schema, block, true);
+    ctx->relative = relative;
+    return ok;
+}
+
+// Note one more open object or array
+static inline void jc_enter(jc_ctx* ctx) {
+    if (++ctx->depth > ctx->max_depth) ctx->max_depth = ctx->depth;
+}
+
+static inline bool jc_parse_int(const char** ptr, const char* end, int* out, char** error) {
+    bool negative;
+    uint64_t mag;
+    if (!jc_parse_integer(ptr, end, &negative, &mag, error)) return false;
+    if (mag > (negative ? (uint64_t)INT_MAX + 1 : (uint64_t)INT_MAX)) {
+        *error = "Integer out of range";
+        return false;
+    }
+    *out = negative ? -(int)(mag - 1) - 1 : (int)mag;
+    return true;
+}
+
+static inline bool jc_parse_int64(const char** ptr, const char* end, int64_t* out, char** error) {
+    bool negative;
+    uint64_t mag;
+    if (!jc_parse_integer(ptr, end, &negative, &mag, error)) return false;
+    if (mag > (negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX)) {
+        *error = "Integer out of range";
+        return false;
+    }
+    *out = negative ? -(int64_t)(mag - 1) - 1 : (int64_t)mag;
+    return true;
+}
+
+static inline bool jc_parse_uint64(const char** ptr, const char* end, uint64_t* out, char** error) {
+    bool negative;
+    uint64_t mag;
+    if (!jc_parse_integer(ptr, end, &negative, &mag, error)) return false;
+    if (negative && mag != 0) {
+        *error = "Integer out of range";
+        return false;
+    }
+    *out = mag;
+    return true;
+}
+
+// Decode a string value into a NUL-terminated buffer of size bytes
+static inline bool jc_parse_string(const char** ptr, const char* end, char* out, size_t size,
+                                   char** error) {
+    if (*ptr >= end || **ptr != '"') {
+        *error = "Expected string value";
+        return false;
+    }
+    (*ptr)++;
+    size_t len;
+    bool escaped;
+    if (!jc_scan_string(ptr, end, out, size, &len, &escaped, error)) return false;
+    out[len] = '\0';
+    return true;
+}
+
+static inline bool jc_parse_bool(const char** ptr, const char* end, bool* out, char** error) {
+    if (end - *ptr >= 4 && memcmp(*ptr, "true", 4) == 0) {
+        *out = true;
+        *ptr += 4;
+        return true;
+    } else if (end - *ptr >= 5 && memcmp(*ptr, "false", 5) == 0) {
+        *out = false;
+        *ptr += 5;
+        return true;
+    }
+    *error = "Invalid boolean value";
+    return false;
+}
+
+// Point a string view into the input after checking it; only note whether
+// escapes need decoding
+static inline bool jc_parse_view(const char** ptr, const char* end, jc_str* out, char** error) {
+    if (*ptr >= end || **ptr != '"') {
+        *error = "Expected string value";
+        return false;
+    }
+    (*ptr)++;
+    out->ptr = *ptr;
+    size_t len;
+    if (!jc_scan_string(ptr, end, NULL, SIZE_MAX, &len, &out->escaped, error)) return false;
+    out->len = (size_t)(*ptr - 1 - out->ptr);
+    return true;
+}
+
+// Read a string value to look up rather than store: *str points into the
+// input when the string has no escapes, and into ctx->key once decoded
+// otherwise, which limits decoded strings to JC_KEY_MAX - 1 bytes
+static bool jc_scan_name(jc_ctx* ctx, const char** ptr, const char** str, size_t* len) {
+    const char* end = ctx->end;
+    if (*ptr >= end || **ptr != '"') {
+        *ctx->error = "Expected string value";
+        return false;
+    }
+    (*ptr)++;
+    *str = *ptr;
+    const char* run = jc_scan_special(*ptr, end);
+    if (run < end && *run == '"') {
+        *len = (size_t)(run - *str);
+        *ptr = run + 1;
+        return true;
+    }
+    bool escaped;
+    if (!jc_scan_string_slow(ptr, end, NULL, SIZE_MAX, len, &escaped, ctx->error)) return false;
+    if (escaped) {
+        if (*len >= JC_KEY_MAX) {
+            *ctx->error = "String too long";
+            return false;
+        }
+        jc_unescape(*str, *ptr - 1, ctx->key, len, ctx->error);
+        *str = ctx->key;
+    }
+    return true;
+}
+
+// Store the index of the name matching a string in an 'e' mapping's list
+static bool jc_parse_enum(jc_ctx* ctx, const char** ptr, const JsonMap* map, int* out,
+                          const jc_schema* names) {
+    const char* str;
+    size_t len;
+    if (!jc_scan_name(ctx, ptr, &str, &len)) return false;
+    int idx = names ? jc_schema_find(names, str, len) : find_mapping(map->nested, map->size, str, len);
+    if (idx < 0) {
+        *ctx->error = "Unknown enum value";
+        return false;
+    }
+    *out = idx;
+    return true;
+}
+
+// Store the interned copy of a string
+static bool jc_parse_interned(jc_ctx* ctx, const char** ptr, const char** out) {
+    const char* str;
+    size_t len;
+    if (!ctx->intern) {
+        *ctx->error = "No intern table for interned string";
+        return false;
+    }
+    if (!jc_scan_name(ctx, ptr, &str, &len)) return false;
+    const char* interned = jc_intern_insert(ctx->intern, str, len, &ctx->allocations);
+    if (!interned) {
+        *ctx->error = "Out of memory";
+        return false;
+    }
+    *out = interned;
+    return true;
+}
+
+// Parse a single value based on type and store it at dst
+static bool parse_value(jc_ctx* ctx, const char** ptr, const JsonMap* map, void* dst,
+                        const jc_schema* nested_schema) {
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    *ptr = jc_skip_ws(*ptr, end);
+    
+    switch (map->type) {
+        case 'i':
+            return jc_parse_int(ptr, end, (int*)dst, error);
+        case 'I':
+            return jc_parse_int64(ptr, end, (int64_t*)dst, error);
+        case 'U':
+            return jc_parse_uint64(ptr, end, (uint64_t*)dst, error);
+        case 's':
+            return jc_parse_string(ptr, end, (char*)dst, map->size, error);
+        case 'S':
+            return jc_parse_view(ptr, end, (jc_str*)dst, error);
+        case 'e':
+            return jc_parse_enum(ctx, ptr, map, (int*)dst, nested_schema);
+        case 'n':
+            return jc_parse_interned(ctx, ptr, (const char**)dst);
+        case 'b':
+            return jc_parse_bool(ptr, end, (bool*)dst, error);
+        case 'd':
+            return jc_parse_double(ptr, end, (double*)dst, error);
+        case 'f':
+            return jc_parse_float(ptr, end, (float*)dst, error);
+        case 'o': {
+            if (nested_schema) {
+                return parse_object(ctx, ptr, nested_schema->maps, nested_schema->count,
+                                    nested_schema, dst, true);
+            }
+            return parse_object(ctx, ptr, map->nested, map->size, NULL, dst, true);
+        }
+        case 'a': {
+            if (*ptr >= end || **ptr != '[') {
+                *error = "Expected array";
+                return false;
+            }
+            (*ptr)++;
+            jc_enter(ctx);
+            
+            // Get array pointer and sizes
+            size_t array_len = map->size;  // Number of elements in array
+            const JsonMap* item_map = map->nested;
+            size_t item_size = jc_item_size(item_map);  // Distance between elements
+            size_t count = 0;
+            if (item_size == 0) {
+                *error = "Missing array item stride";
+                return false;
+            }
+            
+            while (*ptr < end) {
+                if (skip_char(ptr, end, ']')) break;
+                
+                if (count >= array_len) {
+                    *error = "Array too long";
+                    return false;
+                }
+                
+                // Pointer to current array element
+                void* item_ptr = (char*)dst + count * item_size;
+                if (!parse_item(ctx, ptr, item_map, item_ptr, nested_schema)) {
+                    return false;
+                }
+                
+                count++;
+                skip_char(ptr, end, ',');
+            }
+            
+            if (count < array_len) {
+                *error = "Array too short";
+                return false;
+            }
+            ctx->depth--;
+            return true;
+        }
+        case 'v': {
+            if (*ptr >= end || **ptr != '[') {
+                *error = "Expected array";
+                return false;
+            }
+            if (!ctx->arena) {
+                *error = "No arena for variable-length array";
+                return false;
+            }
+            (*ptr)++;
+            jc_enter(ctx);
+
+            // Elements go into an arena block that doubles when full
+            const JsonMap* item_map = map->nested;
+            size_t item_size = jc_item_size(item_map);
+            char* items = NULL;
+            size_t capacity = 0;
+            size_t count = 0;
+            if (item_size == 0) {
+                *error = "Missing array item stride";
+                return false;
+            }
+
+            while (*ptr < end) {
+                if (skip_char(ptr, end, ']')) break;
+
+                if (map->size && count >= map->size) {
+                    *error = "Array too long";
+                    return false;
+                }
+                if (count == capacity) {
+                    size_t grown = capacity ? capacity * 2 : 8;
+                    if (map->size && grown > map->size) grown = map->size;
+                    items = jc_arena_grow(ctx->arena, items, capacity * item_size, grown * item_size);
+                    if (!items) {
+                        *error = "Arena exhausted";
+                        return false;
+                    }
+                    capacity = grown;
+                }
+
+                if (!parse_item(ctx, ptr, item_map, items + count * item_size, nested_schema)) {
+                    return false;
+                }
+
+                count++;
+                skip_char(ptr, end, ',');
+            }
+
+            // Give back the unused tail of the block
+            if (items) jc_arena_grow(ctx->arena, items, capacity * item_size, count * item_size);
+            ((jc_array*)dst)->items = items;
+            ((jc_array*)dst)->count = count;
+            ctx->depth--;
+            return true;
+        }
+        case 'c': {
+            if (*ptr >= end || **ptr != '[') {
+                *error = "Expected array";
+                return false;
+            }
+            (*ptr)++;
+            jc_enter(ctx);
+
+            // dst is a block starting with the row count, followed by the
+            // columns at the offsets given in the row mappings
+            const JsonMap* row_map = map->nested;
+            const JsonMap* fields = nested_schema ? nested_schema->maps : row_map->nested;
+            size_t field_count = nested_schema ? nested_schema->count : row_map->size;
+            if (!nested_schema) {
+                for (size_t i = 0; i < field_count; i++) {
+                    if (jc_type_size(&fields[i]) == 0) {
+                        *error = "Unsupported column type";
+                        return false;
+                    }
+                }
+            }
+            size_t rows = 0;
+
+            while (*ptr < end) {
+                if (skip_char(ptr, end, ']')) break;
+
+                if (rows >= map->size) {
+                    *error = "Array too long";
+                    return false;
+                }
+                if (!parse_row(ctx, ptr, fields, field_count, nested_schema, dst, rows)) {
+                    return false;
+                }
+
+                rows++;
+                skip_char(ptr, end, ',');
+            }
+
+            *(size_t*)dst = rows;
+            ctx->depth--;
+            return true;
+        }
+        default:
+            *error = "Unknown type";
+            return false;
+    }
+}
+
+// Check a key that is not plain ASCII, and decode it into ctx->key if it
+// has escapes so that it matches mappings as written in the schema. Like
+// jc_scan_name(), that limits decoded keys to JC_KEY_MAX - 1 bytes.
+static bool jc_scan_key(jc_ctx* ctx, const char** ptr, const char** key, size_t* key_len) {
+    size_t decoded_len;
+    bool escaped;
+    if (!jc_scan_string_slow(ptr, ctx->end, NULL, SIZE_MAX, &decoded_len, &escaped, ctx->error)) return false;
+    *key_len = (size_t)(*ptr - 1 - *key);
+    if (escaped) {
+        if (decoded_len >= JC_KEY_MAX) {
+            *ctx->error = "String too long";
+            return false;
+        }
+        jc_unescape(*key, *key + *key_len, ctx->key, key_len, ctx->error);
+        *key = ctx->key;
+    }
+    return true;
+}
+
+// Step to the next key of an object whose '{' has been read. Returns 1
+// with *ptr after the ':', 0 after the closing brace, or -1 on error.
+static inline int jc_next_key(jc_ctx* ctx, const char** ptr, bool first, const char** key,
+                              size_t* key_len) {
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    if (*ptr >= end) {
+        *error = "Missing closing brace";
+        return -1;
+    }
+    if (skip_char(ptr, end, '}')) return 0;
+
+    // Check for premature end of input
+    if (*ptr >= end) {
+        *error = "Unexpected end of input";
+        return -1;
+    }
+
+    // Handle comma between fields
+    if (!first && !skip_char(ptr, end, ',')) {
+        *error = "Expected ,";
+        return -1;
+    }
+
+    // Check for trailing comma
+    if (skip_char(ptr, end, '}')) {
+        *error = "Trailing comma";
+        return -1;
+    }
+
+    if (*ptr >= end || **ptr != '"') {
+        *error = "Expected property name";
+        return -1;
+    }
+    (*ptr)++;
+
+    *key = *ptr;
+    const char* run = jc_scan_special(*ptr, end);
+    if (run < end && *run == '"') {
+        *key_len = (size_t)(run - *key);
+        *ptr = run + 1;
+    } else if (!jc_scan_key(ctx, ptr, key, key_len)) {
+        return -1;
+    }
+
+    if (!skip_char(ptr, end, ':')) {
+        *error = "Expected :";
+        return -1;
+    }
+    return 1;
+}
+
+// Parse an object into the given mappings. Keys are looked up through the
+// compiled schema's hash table when one is given, otherwise by linear scan.
+// For offset-based schemas, member offsets are resolved against base.
+static bool parse_object(jc_ctx* ctx, const char** ptr, const JsonMap* maps, size_t count,
+                         const jc_schema* schema, char* base, bool nested) {
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    if (!skip_char(ptr, end, '{')) {
+        *error = nested ? "Expected object" : "Expected {";
+        return false;
+    }
+
+    bool relative = schema ? schema->relative : ctx->relative;
+    bool columnar = ctx->columnar;
+    size_t row = ctx->row;
+    ctx->columnar = false;
+    jc_bits found;
+    if (!jc_bits_init(&found, count, ctx->scratch, &ctx->allocations)) {
+        *error = "Out of memory";
+        return false;
+    }
+    jc_enter(ctx);
+    bool first_field = true;
+    const char* key_start;
+    size_t key_len;
+    int step;
+    _Atomic uint16_t* predict = schema ? schema->predict : NULL;
+    size_t prev = 0;            // Prediction entry for the next key
+    size_t filled = 0;          // Distinct mappings found, when stopping early
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    while ((step = jc_next_key(ctx, ptr, first_field, &key_start, &key_len)) > 0) {
+        // Find matching mapping
+        int index;
+        if (predict) {
+            size_t guess = atomic_load_explicit(&predict[prev], memory_order_relaxed);
+            if (guess && schema->key_lens[guess - 1] == key_len &&
+                memcmp(maps[guess - 1].json_key, key_start, key_len) == 0) {
+                index = (int)guess - 1;
+                hits++;
+            } else {
+                index = jc_schema_find(schema, key_start, key_len);
+                misses++;
+                if (index >= 0) atomic_store_explicit(&predict[prev], (uint16_t)(index + 1), memory_order_relaxed);
+            }
+            if (index >= 0) prev = (size_t)index + 1;
+        } else {
+            index = schema ? jc_schema_find(schema, key_start, key_len)
+                           : find_mapping(maps, count, key_start, key_len);
+        }
+        if (index >= 0) {
+            const JsonMap* map = &maps[index];
+            const jc_schema* nested_schema = schema ? schema->nested[index] : NULL;
+            char* dst = relative ? base + (uintptr_t)map->struct_member : map->struct_member;
+            if (columnar) dst += row * jc_type_size(map);
+            if (!parse_value(ctx, ptr, map, dst, nested_schema)) {
+                goto fail;
+            }
+            uint64_t* word = jc_bits_words(&found) + index / 64;
+            uint64_t bit = 1ULL << (index % 64);
+            bool complete = !nested && ctx->stop_when_complete && !(*word & bit) && ++filled == count;
+            *word |= bit;
+            ctx->matched++;
+            JC_HOOK_FIELD(map);
+            if (complete) {
+                ctx->stopped = true;
+                break;
+            }
+        } else {
+            ctx->skipped++;
+            JC_HOOK_SKIP(key_start, key_len);
+            jc_skip_unknown(ctx, ptr);
+        }
+
+        first_field = false;
+    }
+    if (predict) {
+        // One shared update per object keeps the counters off the key path
+        jc_schema* counted = (jc_schema*)schema;
+        if (hits) atomic_fetch_add_explicit(&counted->hits, hits, memory_order_relaxed);
+        if (misses) atomic_fetch_add_explicit(&counted->misses, misses, memory_order_relaxed);
+    }
+    if (step < 0) goto fail;
+
+    // Check if all required fields were found
+    uint64_t* words = jc_bits_words(&found);
+    for (size_t i = 0; i < count; i++) {
+        if (schema && i % 64 == 0) {
+            // Compare a whole word of required flags at once
+            uint64_t required = schema->required[i / 64];
+            if ((words[i / 64] & required) == required) {
+                i += 63;
+                continue;
+            }
+        }
+        if (maps[i].required && !(words[i / 64] & (1ULL << (i % 64)))) {
+            *error = nested ? "Missing required field in nested object" : "Missing required field";
+            goto fail;
+        }
+    }
+
+    jc_bits_release(&found);
+    ctx->depth--;
+    return true;
+
+fail:
+    jc_bits_release(&found);
+    return false;
+}
+
+// Parse the first len bytes of json; the input need not be NUL-terminated
+// and nothing past json + len is read
+bool parse_json_n(const char* json, size_t len, JsonMap* mappings, int map_count, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+
+    char key[JC_KEY_MAX];
+    jc_ctx ctx = jc_ctx_init(json + len, error, json);
+    ctx.key = key;
+    const char* ptr = json;
+    if (!parse_object(&ctx, &ptr, mappings, map_count, NULL, NULL, false)) {
+        return false;
+    }
+
+    // Check for trailing content
+    if (!is_end(ptr, ctx.end)) {
+        *error = "Unexpected content after }";
+        return false;
+    }
+    return true;
+}
+
+// Main parsing function
+bool parse_json(const char* json, JsonMap* mappings, int map_count, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    return parse_json_n(json, strlen(json), mappings, map_count, error);
+}
+
+// Release a schema returned by jc_schema_compile()
+void jc_schema_free(jc_schema* schema) {
+    if (!schema) return;
+    if (schema->nested) {
+        for (size_t i = 0; i < schema->count; i++) {
+            jc_schema_free(schema->nested[i]);
+        }
+    }
+    JC_FREE(schema->nested);
+    JC_FREE(schema->items);
+    JC_FREE(schema->keys);
+    JC_FREE(schema->slots);
+    JC_FREE(schema->key_lens);
+    JC_FREE(schema->required);
+    JC_FREE((void*)schema->predict);
+    JC_FREE(schema->maps);
+    JC_FREE(schema);
+}
+
+// Turn on key-order prediction for a schema and the schemas nested in it.
+// Each object then checks the mapping that followed the previous key last
+// time with one length compare and memcmp before hashing the key, which
+// makes matching nearly free for producers with a stable field order.
+// Call before sharing the schema between threads.
+bool jc_schema_predict(jc_schema* schema, char** error) {
+    if (!schema->predict) {
+        schema->predict = JC_CALLOC(schema->count + 1, sizeof(*schema->predict));
+        if (!schema->predict) {
+            *error = "Out of memory";
+            return false;
+        }
+    }
+    for (size_t i = 0; schema->nested && i < schema->count; i++) {
+        if (schema->nested[i] && !jc_schema_predict(schema->nested[i], error)) return false;
+    }
+    return true;
+}
+
+// Add up the prediction hits and misses of a schema and its nested schemas.
+// Keys without a mapping count as misses.
+void jc_schema_predict_stats(const jc_schema* schema, uint64_t* hits, uint64_t* misses) {
+    *hits += atomic_load_explicit(&schema->hits, memory_order_relaxed);
+    *misses += atomic_load_explicit(&schema->misses, memory_order_relaxed);
+    for (size_t i = 0; schema->nested && i < schema->count; i++) {
+        if (schema->nested[i]) jc_schema_predict_stats(schema->nested[i], hits, misses);
+    }
+}
+
+// Build the key hash table, preferring a seed without collisions
+static void jc_schema_build_index(jc_schema* schema) {
+    size_t table_size = schema->slot_mask + 1;
+
+    // Search a few seeds for a perfect hash; fall back to linear probing
+    for (uint32_t attempt = 0; attempt < 64; attempt++) {
+        uint32_t seed = 0x811c9dc5u + attempt * 0x9e3779b9u;
+        memset(schema->slots, 0, table_size * sizeof(uint16_t));
+        bool perfect = true;
+        for (size_t i = 0; i < schema->count; i++) {
+            size_t slot = jc_hash_key(schema->maps[i].json_key, schema->key_lens[i], seed) & schema->slot_mask;
+            while (schema->slots[slot]) {
+                perfect = false;
+                slot = (slot + 1) & schema->slot_mask;
+            }
+            schema->slots[slot] = (uint16_t)(i + 1);
+        }
+        schema->seed = seed;
+        schema->perfect = perfect;
+        if (perfect) return;
+    }
+}
+
+// Compile one level of mappings and, recursively, its nested objects
+static jc_schema* jc_schema_compile_level(const JsonMap* mappings, size_t count,
+                                          bool relative, char** error) {
+    if (!mappings && count > 0) {
+        *error = "Missing nested mappings";
+        return NULL;
+    }
+    if (count >= UINT16_MAX) {
+        *error = "Too many mappings";
+        return NULL;
+    }
+
+    jc_schema* schema = JC_CALLOC(1, sizeof(jc_schema));
+    if (!schema) {
+        *error = "Out of memory";
+        return NULL;
+    }
+    schema->count = count;
+    schema->relative = relative;
+
+    size_t table_size = 8;
+    while (table_size < count * 2) table_size <<= 1;
+    schema->slot_mask = table_size - 1;
+    size_t keys_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!mappings[i].json_key) {
+            *error = "Missing key in mapping";
+            jc_schema_free(schema);
+            return NULL;
+        }
+        keys_size += strlen(mappings[i].json_key) + 1;
+    }
+
+    schema->maps = JC_CALLOC(count ? count : 1, sizeof(JsonMap));
+    schema->key_lens = JC_CALLOC(count ? count : 1, sizeof(size_t));
+    schema->slots = JC_CALLOC(table_size, sizeof(uint16_t));
+    schema->nested = JC_CALLOC(count ? count : 1, sizeof(jc_schema*));
+    schema->items = JC_CALLOC(count ? count : 1, sizeof(JsonMap));
+    schema->keys = JC_MALLOC(keys_size ? keys_size : 1);
+    schema->required = JC_CALLOC(count / 64 + 1, sizeof(uint64_t));
+    if (!schema->maps || !schema->key_lens || !schema->slots ||
+        !schema->nested || !schema->items || !schema->keys || !schema->required) {
+        *error = "Out of memory";
+        jc_schema_free(schema);
+        return NULL;
+    }
+
+    char* key_out = schema->keys;
+    for (size_t i = 0; i < count; i++) {
+        JsonMap* map = &schema->maps[i];
+        *map = mappings[i];
+
+        size_t key_len = strlen(mappings[i].json_key);
+        memcpy(key_out, mappings[i].json_key, key_len + 1);
+        map->json_key = key_out;
+        schema->key_lens[i] = key_len;
+        key_out += key_len + 1;
+
+        if (map->required) {
+            schema->required[i / 64] |= 1ULL << (i % 64);
+        }
+
+        if (find_mapping(schema->maps, i, map->json_key, key_len) >= 0) {
+            *error = "Duplicate key in mappings";
+            jc_schema_free(schema);
+            return NULL;
+        }
+
+        if (map->type == 'o' || map->type == 'e') {
+            // Enum names are looked up through a schema of their own
+            schema->nested[i] = jc_schema_compile_level(mappings[i].nested, mappings[i].size,
+                                                        relative, error);
+            if (!schema->nested[i]) {
+                jc_schema_free(schema);
+                return NULL;
+            }
+            map->nested = schema->nested[i]->maps;
+        } else if (map->type == 'a' || map->type == 'v' || map->type == 'c') {
+            if (!mappings[i].nested) {
+                *error = "Missing array item mapping";
+                jc_schema_free(schema);
+                return NULL;
+            }
+            JsonMap* item = &schema->items[i];
+            *item = *mappings[i].nested;
+            map->nested = item;
+            if (map->type == 'c' && item->type != 'o') {
+                *error = "Columnar array needs an object row mapping";
+                jc_schema_free(schema);
+                return NULL;
+            }
+
+            if (item->type == 'o') {
+                // Elements and rows hold offsets within one element or
+                // the column block, whatever the outer schema uses
+                if (map->type != 'c' && !item->struct_member) {
+                    *error = "Missing array item stride";
+                    jc_schema_free(schema);
+                    return NULL;
+                }
+                schema->nested[i] = jc_schema_compile_level(item->nested, item->size, true, error);
+                if (!schema->nested[i]) {
+                    jc_schema_free(schema);
+                    return NULL;
+                }
+                item->nested = schema->nested[i]->maps;
+                for (size_t f = 0; map->type == 'c' && f < item->size; f++) {
+                    if (jc_type_size(&item->nested[f]) == 0) {
+                        *error = "Unsupported column type";
+                        jc_schema_free(schema);
+                        return NULL;
+                    }
+                }
+            } else if (item->type == 'e') {
+                schema->nested[i] = jc_schema_compile_level(item->nested, item->size, true, error);
+                if (!schema->nested[i]) {
+                    jc_schema_free(schema);
+                    return NULL;
+                }
+                item->nested = schema->nested[i]->maps;
+            } else if (jc_item_size(item) == 0) {
+                *error = "Missing array item stride";
+                jc_schema_free(schema);
+                return NULL;
+            }
+        }
+    }
+
+    jc_schema_build_index(schema);
+    return schema;
+}
+
+// Compile a mapping tree into an immutable schema: key lengths are
+// precomputed, keys are dispatched through a hash table and nested objects
+// are compiled up front. Returns NULL and sets error on failure.
+jc_schema* jc_schema_compile(const JsonMap* mappings, int map_count, char** error) {
+    if (!mappings || map_count < 0) {
+        *error = "Invalid mappings";
+        return NULL;
+    }
+    return jc_schema_compile_level(mappings, (size_t)map_count, false, error);
+}
+
+// Compile mappings whose struct_member fields hold member offsets (see
+// JC_OFFSET) rather than pointers. The result is not tied to any struct
+// instance: one schema can fill any number of structs, from any number of
+// threads, through parse_json_into().
+jc_schema* jc_schema_compile_offsets(const JsonMap* mappings, int map_count, char** error) {
+    if (!mappings || map_count < 0) {
+        *error = "Invalid mappings";
+        return NULL;
+    }
+    return jc_schema_compile_level(mappings, (size_t)map_count, true, error);
+}
+
+// Copy a finished parse's counters into stats; stop is where it ended
+static void jc_fill_stats(jc_stats* stats, const jc_ctx* ctx, const char* json, const char* stop,
+                          bool ok) {
+    stats->bytes = (size_t)(stop - json);
+    stats->fields_matched = ctx->matched;
+    stats->keys_skipped = ctx->skipped;
+    stats->max_depth = ctx->max_depth;
+    stats->allocations = ctx->allocations;
+    stats->error_offset = 0;
+    stats->error_line = 0;
+    stats->error_column = 0;
+    if (ok) return;
+
+    // Locate the error only on failure, so successful parses never rescan
+    size_t line = 1;
+    const char* line_start = json;
+    const char* nl;
+    while ((nl = memchr(line_start, '\n', (size_t)(stop - line_start))) != NULL) {
+        line++;
+        line_start = nl + 1;
+    }
+    stats->error_offset = (size_t)(stop - json);
+    stats->error_line = line;
+    stats->error_column = (size_t)(stop - line_start) + 1;
+}
+
+// Object parser generated by JC_STRUCT()
+typedef bool (*jc_object_fn)(jc_ctx* ctx, const char** ptr, void* out, bool nested);
+
+// Parse one complete document in [json, end) with a compiled schema, or
+// with a generated object parser when fn is set
+static bool jc_run_document(const jc_schema* schema, jc_object_fn fn, void* base, const char* json,
+                            const char* end, const jc_options* opts, char** error) {
+    char key[JC_KEY_MAX];
+    jc_ctx ctx = jc_ctx_init(end, error, json);
+    ctx.key = key;
+    if (opts) {
+        ctx.scratch = opts->scratch;
+        ctx.arena = opts->arena;
+        ctx.stop_when_complete = opts->stop_when_complete;
+        ctx.intern = opts->intern;
+    }
+    const char* ptr = json;
+    bool ok = true;
+    JC_HOOK_BEGIN(schema, json, (size_t)(end - json));
+    if (opts && opts->index) {
+        jc_index* index = opts->index;
+        size_t cap = index->cap;
+        ok = jc_index_build(index, json, (size_t)(end - json), error);
+        if (index->cap != cap) ctx.allocations++;
+        if (index->count) ctx.index = index;
+    }
+    if (ok) {
+        ok = fn ? fn(&ctx, &ptr, base, false)
+                : parse_object(&ctx, &ptr, schema->maps, schema->count, schema, base, false);
+    }
+
+    // Check for trailing content
+    if (ok && !ctx.stopped && !is_end(ptr, end)) {
+        *error = "Unexpected content after }";
+        ok = false;
+    }
+
+    jc_stats local;
+    jc_stats* stats = opts && opts->stats ? opts->stats : &local;
+    jc_fill_stats(stats, &ctx, json, ok && !ctx.stopped ? end : ptr, ok);
+    JC_HOOK_END(schema, stats, ok);
+    return ok;
+}
+
+// Parse one complete document in [json, end) with a compiled schema
+static bool jc_parse_document(const jc_schema* schema, void* base, const char* json,
+                              const char* end, const jc_options* opts, char** error) {
+    return jc_run_document(schema, NULL, base, json, end, opts, error);
+}
+
+// Parse len bytes of JSON into the struct at base using a compiled schema,
+// with optional settings (opts may be NULL)
+bool parse_json_ex(const jc_schema* schema, void* base, const char* json, size_t len,
+                   const jc_options* opts, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    if (!schema) {
+        *error = "NULL schema";
+        return false;
+    }
+    if (schema->relative && !base) {
+        *error = "NULL destination";
+        return false;
+    }
+
+    return jc_parse_document(schema, base, json, json + len, opts, error);
+}
+
+// Parse len bytes of JSON into the struct at base using a compiled schema.
+// The schema is only read, so concurrent calls may share it. base is
+// ignored for schemas compiled from absolute pointers with
+// jc_schema_compile().
+bool parse_json_into_n(const jc_schema* schema, void* base, const char* json, size_t len,
+                       char** error) {
+    return parse_json_ex(schema, base, json, len, NULL, error);
+}
+
+// parse_json_into_n() for a NUL-terminated string
+bool parse_json_into(const jc_schema* schema, void* base, const char* json, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    return parse_json_into_n(schema, base, json, strlen(json), error);
+}
+
+// Parse JSON using a compiled schema built from absolute pointers
+bool parse_json_schema(const char* json, const jc_schema* schema, char** error) {
+    return parse_json_into(schema, NULL, json, error);
+}
+
+// Entry point of the parsers generated by JC_STRUCT()
+bool jc_parse_generated(jc_object_fn fn, void* out, const char* json, size_t len,
+                        const jc_options* opts, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    if (!out) {
+        *error = "NULL destination";
+        return false;
+    }
+    return jc_run_document(NULL, fn, out, json, json + len, opts, error);
+}
+
+// Open an object for a generated parser
+static inline bool jc_object_open(jc_ctx* ctx, const char** ptr, bool nested) {
+    if (!skip_char(ptr, ctx->end, '{')) {
+        *ctx->error = nested ? "Expected object" : "Expected {";
+        return false;
+    }
+    ctx->columnar = false;
+    jc_enter(ctx);
+    return true;
+}
+
+// Skip the value of a key a generated parser does not know
+static inline void jc_object_skip(jc_ctx* ctx, const char** ptr, const char* key, size_t key_len) {
+    ctx->skipped++;
+    JC_HOOK_SKIP(key, key_len);
+    (void)key;
+    (void)key_len;
+    jc_skip_unknown(ctx, ptr);
+}
+
+// Close an object for a generated parser once every required field is found
+static inline bool jc_object_close(jc_ctx* ctx, uint64_t found, uint64_t required, bool nested) {
+    if ((found & required) != required) {
+        *ctx->error = nested ? "Missing required field in nested object" : "Missing required field";
+        return false;
+    }
+    ctx->depth--;
+    return true;
+}
+
+// Schema DSL generating a struct and a dedicated parser for it:
+//
+//     JC_STRUCT(Point, JC_INT(x) JC_INT(y))
+//     JC_STRUCT(Shape, JC_STR(name, 32) JC_OBJ(origin, Point) JC_OPTIONAL(JC_DOUBLE(scale)))
+//
+// declares typedef struct Shape {...} Shape and
+//
+//     bool jc_parse_Shape(Shape* out, const char* json, size_t len,
+//                         const jc_options* opts, char** error);
+//
+// Keys are matched by comparing against constant strings of known length
+// and each value goes straight to its type's parser, with no mapping table
+// to interpret. Fields are required unless wrapped in JC_OPTIONAL(); a
+// struct holds at most 64 fields, and JC_OBJ() types must be declared
+// first. Each field expands to a (kind, C type, name, size, required) tuple.
+#define JC_INT(name) (i, int, name, 0, 1)
+#define JC_INT64(name) (I, int64_t, name, 0, 1)
+#define JC_UINT64(name) (U, uint64_t, name, 0, 1)
+#define JC_DOUBLE(name) (d, double, name, 0, 1)
+#define JC_FLOAT(name) (f, float, name, 0, 1)
+#define JC_BOOL(name) (b, bool, name, 0, 1)
+#define JC_STR(name, size) (s, char, name, size, 1)
+#define JC_OBJ(name, type) (o, type, name, 0, 1)
+#define JC_OPTIONAL(field) JC_OPTIONAL_I field
+#define JC_OPTIONAL_I(kind, type, name, size, required) (kind, type, name, size, 0)
+
+#define JC_STRUCT(Name, fields)                                                              \
+    typedef struct Name {                                                                    \
+        JC_EACH(JC_DECL_A fields)                                                            \
+    } Name;                                                                                  \
+    static bool jc_object_##Name(jc_ctx* ctx, const char** ptr, void* dst, bool nested) {   \
+        struct jc_fields { JC_EACH(JC_FIELD_A fields) };                                     \
+        _Static_assert(sizeof(struct jc_fields) <= 64, "JC_STRUCT holds at most 64 fields"); \
+        static const uint64_t required = 0 JC_EACH(JC_REQUIRED_A fields);                    \
+        static const uint64_t all = ~0ULL >> (64 - sizeof(struct jc_fields));                \
+        Name* out = dst;                                                                     \
+        uint64_t found = 0;                                                                  \
+        const char* key;                                                                     \
+        size_t key_len;                                                                      \
+        bool first = true;                                                                   \
+        int step;                                                                            \
+        if (!jc_object_open(ctx, ptr, nested)) return false;                                 \
+        while ((step = jc_next_key(ctx, ptr, first, &key, &key_len)) > 0) {                  \
+            first = false;                                                                   \
+            *ptr = jc_skip_ws(*ptr, ctx->end);                                               \
+            JC_EACH(JC_MATCH_A fields) {                                                     \
+                jc_object_skip(ctx, ptr, key, key_len);                                      \
+                continue;                                                                    \
+            }                                                                                \
+            ctx->matched++;                                                                  \
+            JC_HOOK_FIELD(NULL);                                                             \
+            if (!nested && ctx->stop_when_complete && found == all) {                        \
+                ctx->stopped = true;                                                         \
+                step = 0;                                                                    \
+                break;                                                                       \
+            }                                                                                \
+        }                                                                                    \
+        return step == 0 && jc_object_close(ctx, found, required, nested);                   \
+    }                                                                                        \
+    bool jc_parse_##Name(Name* out, const char* json, size_t len, const jc_options* opts,    \
+                         char** error) {                                                     \
+        return jc_parse_generated(jc_object_##Name, out, json, len, opts, error);            \
+    }
+
+// Expand a sequence of field tuples with the macro pair starting at the
+// sequence; the pair alternates so each tuple invokes the next macro, and
+// the trailing name is pasted with _END into an empty macro.
+#define JC_EACH(seq) JC_CAT(seq, _END)
+#define JC_CAT(a, b) JC_CAT_I(a, b)
+#define JC_CAT_I(a, b) a##b
+
+// Struct members
+#define JC_DECL_A(kind, type, name, size, required) JC_DECL_##kind(type, name, size) JC_DECL_B
+#define JC_DECL_B(kind, type, name, size, required) JC_DECL_##kind(type, name, size) JC_DECL_A
+#define JC_DECL_A_END
+#define JC_DECL_B_END
+#define JC_DECL_i(type, name, size) type name;
+#define JC_DECL_I(type, name, size) type name;
+#define JC_DECL_U(type, name, size) type name;
+#define JC_DECL_d(type, name, size) type name;
+#define JC_DECL_f(type, name, size) type name;
+#define JC_DECL_b(type, name, size) type name;
+#define JC_DECL_s(type, name, size) type name[size];
+#define JC_DECL_o(type, name, size) type name;
+
+// Field numbers for the found flags, as offsets of one-byte members; an
+// enum would need commas, which would split the sequence's expansion
+#define JC_FIELD_A(kind, type, name, size, required) char name; JC_FIELD_B
+#define JC_FIELD_B(kind, type, name, size, required) char name; JC_FIELD_A
+#define JC_FIELD_A_END
+#define JC_FIELD_B_END
+#define JC_FIELD_BIT(name) (1ULL << offsetof(struct jc_fields, name))
+
+// Mask of required fields
+#define JC_REQUIRED_A(kind, type, name, size, required) | (required ? JC_FIELD_BIT(name) : 0) JC_REQUIRED_B
+#define JC_REQUIRED_B(kind, type, name, size, required) | (required ? JC_FIELD_BIT(name) : 0) JC_REQUIRED_A
+#define JC_REQUIRED_A_END
+#define JC_REQUIRED_B_END
+
+// Key comparison and value parse, chained with else
+#define JC_MATCH_A(kind, type, name, size, required) JC_MATCH(kind, type, name, size) JC_MATCH_B
+#define JC_MATCH_B(kind, type, name, size, required) JC_MATCH(kind, type, name, size) JC_MATCH_A
+#define JC_MATCH_A_END
+#define JC_MATCH_B_END
+#define JC_MATCH(kind, type, name, size)                                                     \
+    if (key_len == sizeof(#name) - 1 && memcmp(key, #name, sizeof(#name) - 1) == 0) {        \
+        if (!JC_VALUE_##kind(type, &out->name, size)) return false;                          \
+        found |= JC_FIELD_BIT(name);                                                         \
+    } else
+
+#define JC_VALUE_i(type, dst, size) jc_parse_int(ptr, ctx->end, dst, ctx->error)
+#define JC_VALUE_I(type, dst, size) jc_parse_int64(ptr, ctx->end, dst, ctx->error)
+#define JC_VALUE_U(type, dst, size) jc_parse_uint64(ptr, ctx->end, dst, ctx->error)
+#define JC_VALUE_d(type, dst, size) jc_parse_double(ptr, ctx->end, dst, ctx->error)
+#define JC_VALUE_f(type, dst, size) jc_parse_float(ptr, ctx->end, dst, ctx->error)
+#define JC_VALUE_b(type, dst, size) jc_parse_bool(ptr, ctx->end, dst, ctx->error)
+#define JC_VALUE_s(type, dst, size) jc_parse_string(ptr, ctx->end, *(dst), size, ctx->error)
+#define JC_VALUE_o(type, dst, size) jc_object_##type(ctx, ptr, dst, true)
+
+// A value located by jc_get_path(): len bytes of JSON text at ptr, with
+// strings keeping their quotes and escapes
+typedef struct jc_value {
+    const char* ptr;
+    size_t len;
+    char type;                  // 'o' object, 'a' array, 's' string, 'd' number, 'b' boolean, 'n' null
+} jc_value;
+
+// State of a path query
+typedef struct jc_path_query {
+    jc_ctx ctx;
+    const JsonMap* paths;       // json_key holds a dotted path
+    jc_value* values;           // Raw results, or NULL to parse into the mappings
+    size_t pos[64];             // Start of each path's segment at the current depth
+    uint64_t found;
+    size_t remaining;           // Paths still missing; the walk stops at 0
+} jc_path_query;
+
+// Index named by an array path segment, or SIZE_MAX if it is not a number
+static size_t jc_segment_index(const char* seg, size_t len) {
+    if (len == 0 || len > 18) return SIZE_MAX;
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (seg[i] < '0' || seg[i] > '9') return SIZE_MAX;
+        n = n * 10 + (size_t)(seg[i] - '0');
+    }
+    return n;
+}
+
+// Length of the segment of path p at the current depth
+static inline size_t jc_segment_len(const jc_path_query* q, size_t p) {
+    const char* seg = q->paths[p].json_key + q->pos[p];
+    const char* dot = strchr(seg, '.');
+    return dot ? (size_t)(dot - seg) : strlen(seg);
+}
+
+// Move path p one segment down, returning the position to restore
+static inline size_t jc_segment_descend(jc_path_query* q, size_t p, size_t seg_len) {
+    size_t saved = q->pos[p];
+    const char* path = q->paths[p].json_key;
+    q->pos[p] += seg_len + (path[q->pos[p] + seg_len] == '.');
+    return saved;
+}
+
+static bool jc_path_visit(jc_path_query* q, const char** ptr, uint64_t active);
+
+// Visit the child values selected by key (or, in arrays, by index) for the
+// paths in active, and skip the rest without parsing them
+static bool jc_path_child(jc_path_query* q, const char** ptr, uint64_t active, const char* key,
+                          size_t key_len, size_t index) {
+    uint64_t child = 0;
+    size_t saved[64];
+    for (uint64_t m = active & ~q->found; m; m &= m - 1) {
+        size_t p = jc_ctz64(m);
+        size_t seg_len = jc_segment_len(q, p);
+        const char* seg = q->paths[p].json_key + q->pos[p];
+        bool match = key ? seg_len == key_len && memcmp(seg, key, key_len) == 0
+                         : jc_segment_index(seg, seg_len) == index;
+        if (match) {
+            saved[p] = jc_segment_descend(q, p, seg_len);
+            child |= 1ULL << p;
+        }
+    }
+    if (!child) {
+        skip_value(ptr, q->ctx.end);
+        return true;
+    }
+    bool ok = jc_path_visit(q, ptr, child);
+    for (uint64_t m = child; m; m &= m - 1) {
+        size_t p = jc_ctz64(m);
+        q->pos[p] = saved[p];
+    }
+    return ok;
+}
+
+// Visit the value at *ptr, which the paths in active lead to so far: store
+// the paths that end here and walk into it for the rest
+static bool jc_path_visit(jc_path_query* q, const char** ptr, uint64_t active) {
+    jc_ctx* ctx = &q->ctx;
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    *ptr = jc_skip_ws(*ptr, end);
+    const char* start = *ptr;
+    if (start >= end) {
+        *error = "Unexpected end of input";
+        return false;
+    }
+
+    uint64_t deeper = 0;
+    const char* after = NULL;
+    for (uint64_t m = active & ~q->found; m; m &= m - 1) {
+        size_t p = jc_ctz64(m);
+        const JsonMap* path = &q->paths[p];
+        if (path->json_key[q->pos[p]] != '\0') {
+            deeper |= 1ULL << p;
+            continue;
+        }
+        const char* value_end = start;
+        if (q->values) {
+            skip_value(&value_end, end);
+            jc_value* value = &q->values[p];
+            value->ptr = start;
+            value->len = (size_t)(value_end - start);
+            value->type = *start == '{' ? 'o' : *start == '[' ? 'a' : *start == '"' ? 's'
+                        : *start == 't' || *start == 'f' ? 'b' : *start == 'n' ? 'n' : 'd';
+        } else if (!parse_value(ctx, &value_end, path, path->struct_member, NULL)) {
+            return false;
+        }
+        after = value_end;
+        q->found |= 1ULL << p;
+        q->remaining--;
+    }
+    if (!deeper) {
+        if (after) {
+            *ptr = after;
+        } else {
+            skip_value(ptr, end);
+        }
+        return true;
+    }
+
+    if (*start == '{') {
+        (*ptr)++;
+        const char* key;
+        size_t key_len;
+        int step;
+        bool first = true;
+        while ((step = jc_next_key(ctx, ptr, first, &key, &key_len)) > 0) {
+            first = false;
+            if (!jc_path_child(q, ptr, deeper, key, key_len, 0)) return false;
+            if (q->remaining == 0) return true;
+        }
+        return step == 0;
+    }
+    if (*start == '[') {
+        *ptr = jc_skip_ws(*ptr + 1, end);
+        if (*ptr < end && **ptr == ']') {
+            (*ptr)++;
+            return true;
+        }
+        for (size_t index = 0;; index++) {
+            if (!jc_path_child(q, ptr, deeper, NULL, 0, index)) return false;
+            if (q->remaining == 0) return true;
+            *ptr = jc_skip_ws(*ptr, end);
+            if (*ptr < end && **ptr == ',') {
+                (*ptr)++;
+            } else if (*ptr < end && **ptr == ']') {
+                (*ptr)++;
+                return true;
+            } else {
+                *error = "Expected , or ]";
+                return false;
+            }
+        }
+    }
+    skip_value(ptr, end);
+    return true;
+}
+
+// Walk the document for up to 64 paths, stopping once all are found
+static bool jc_path_run(jc_path_query* q, const char* json, size_t len, size_t count, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    if (count > 64) {
+        *error = "Too many paths";
+        return false;
+    }
+    char key[JC_KEY_MAX];
+    jc_ctx ctx = jc_ctx_init(json + len, error, json);
+    ctx.key = key;
+    q->ctx = ctx;
+    q->found = 0;
+    q->remaining = count;
+    memset(q->pos, 0, sizeof(q->pos));
+    const char* ptr = json;
+    uint64_t all = count == 64 ? ~0ULL : (1ULL << count) - 1;
+    return count == 0 || jc_path_visit(q, &ptr, all);
+}
+
+// Locate the value at a dotted path such as "address.city" or "items.0.id"
+// without parsing the rest of the document. Reading stops at the value;
+// unrelated objects and arrays are skipped by scanning for their end.
+bool jc_get_path(const char* json, size_t len, const char* path, jc_value* out, char** error) {
+    JsonMap map = {path, NULL, 0, 0, true, NULL};
+    jc_path_query q;
+    q.paths = &map;
+    q.values = out;
+    if (!jc_path_run(&q, json, len, 1, error)) return false;
+    if (!q.found) {
+        *error = "Path not found";
+        return false;
+    }
+    return true;
+}
+
+// Parse the values at up to 64 dotted paths (the mappings' json_key) into
+// their struct_member pointers, reading only as far as the last one found.
+// Required paths that are absent are an error.
+bool jc_get_paths(const char* json, size_t len, const JsonMap* paths, int count, char** error) {
+    jc_path_query q;
+    q.paths = paths;
+    q.values = NULL;
+    if (!jc_path_run(&q, json, len, (size_t)count, error)) return false;
+    for (int i = 0; i < count; i++) {
+        if (paths[i].required && !(q.found & (1ULL << i))) {
+            *error = "Missing required field";
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifndef JC_DOC_MAX_DEPTH
+#define JC_DOC_MAX_DEPTH 1024       // Deepest nesting jc_doc_parse() and jc_validate() accept
+#endif
+
+// Schemaless parse of a whole document into a tape of 64-bit words in an
+// arena. The top byte of each word is a tag:
+//   '{' '['  bits 0-31: tape index just past the matching close word,
+//            bits 32-55: member or element count (saturating)
+//   '}' ']'  byte offset of the opening bracket in the input
+//   '"'      byte offset of the string's first character in the input; the
+//            next word holds its length, with bit 63 set if it has escapes
+//   'l' 'u' 'd'  the next word holds an int64, uint64 or double
+//   't' 'f' 'n'  true, false, null
+// Object members are a key string followed by the value. Strings point into
+// the input, which must outlive the doc.
+typedef struct jc_doc {
+    const char* json;
+    size_t len;                 // Input bytes
+    const uint64_t* tape;
+    size_t count;               // Tape words
+} jc_doc;
+
+// A position on a jc_doc tape: a value, an object key, or the end of a
+// container (jc_cursor_type() 0)
+typedef struct jc_cursor {
+    const jc_doc* doc;
+    size_t pos;
+} jc_cursor;
+
+#define JC_TAPE(tag, payload) (((uint64_t)(unsigned char)(tag) << 56) | (uint64_t)(payload))
+#define JC_TAPE_TAG(word) ((char)((word) >> 56))
+#define JC_TAPE_PAYLOAD(word) ((word) & 0x00FFFFFFFFFFFFFFULL)
+
+// Tape under construction
+typedef struct jc_tape {
+    jc_arena* arena;
+    uint64_t* words;
+    size_t count;
+    size_t cap;
+    const char* json;
+    const char* end;
+    char** error;
+} jc_tape;
+
+static bool jc_tape_push(jc_tape* t, uint64_t word) {
+    if (t->count == t->cap) {
+        size_t grown = t->cap ? t->cap * 2 : 64;
+        uint64_t* words = jc_arena_grow(t->arena, t->words, t->cap * sizeof(uint64_t), grown * sizeof(uint64_t));
+        if (!words) {
+            *t->error = "Arena exhausted";
+            return false;
+        }
+        t->words = words;
+        t->cap = grown;
+    }
+    t->words[t->count++] = word;
+    return true;
+}
+
+static bool jc_tape_string(jc_tape* t, const char** ptr) {
+    jc_str str;
+    if (!jc_parse_view(ptr, t->end, &str, t->error)) return false;
+    return jc_tape_push(t, JC_TAPE('"', str.ptr - t->json)) &&
+           jc_tape_push(t, (uint64_t)str.len | ((uint64_t)str.escaped << 63));
+}
+
+static bool jc_tape_number(jc_tape* t, const char** ptr) {
+    const char* p = *ptr;
+    bool negative;
+    uint64_t mag;
+    char* ignored;
+    if (jc_parse_integer(&p, t->end, &negative, &mag, &ignored) &&
+        (!negative || mag <= (uint64_t)INT64_MAX + 1)) {
+        *ptr = p;
+        if (!negative && mag > (uint64_t)INT64_MAX) {
+            return jc_tape_push(t, JC_TAPE('u', 0)) && jc_tape_push(t, mag);
+        }
+        int64_t v = negative ? -(int64_t)(mag - 1) - 1 : (int64_t)mag;
+        return jc_tape_push(t, JC_TAPE('l', 0)) && jc_tape_push(t, (uint64_t)v);
+    }
+
+    // Fractions, exponents and integers beyond 64 bits become doubles
+    double d;
+    if (!jc_parse_double(ptr, t->end, &d, t->error)) return false;
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return jc_tape_push(t, JC_TAPE('d', 0)) && jc_tape_push(t, bits);
+}
+
+static bool jc_tape_value(jc_tape* t, const char** ptr, size_t depth) {
+    const char* end = t->end;
+    char** error = t->error;
+    *ptr = jc_skip_ws(*ptr, end);
+    if (*ptr >= end) {
+        *error = "Unexpected end of input";
+        return false;
+    }
+    char c = **ptr;
+    if (c == '"') return jc_tape_string(t, ptr);
+    if (c == 't' || c == 'f' || c == 'n') {
+        const char* word = c == 't' ? "true" : c == 'f' ? "false" : "null";
+        size_t n = strlen(word);
+        if ((size_t)(end - *ptr) < n || memcmp(*ptr, word, n) != 0) {
+            *error = "Invalid value";
+            return false;
+        }
+        *ptr += n;
+        return jc_tape_push(t, JC_TAPE(c, 0));
+    }
+    if (c != '{' && c != '[') return jc_tape_number(t, ptr);
+
+    if (depth >= JC_DOC_MAX_DEPTH) {
+        *error = "Nesting too deep";
+        return false;
+    }
+    char close = c == '{' ? '}' : ']';
+    size_t open_pos = t->count;
+    size_t open_offset = (size_t)(*ptr - t->json);
+    if (!jc_tape_push(t, 0)) return false;
+    (*ptr)++;
+    size_t members = 0;
+    if (!skip_char(ptr, end, close)) {
+        for (;;) {
+            if (c == '{') {
+                *ptr = jc_skip_ws(*ptr, end);
+                if (*ptr >= end || **ptr != '"') {
+                    *error = members && *ptr < end && **ptr == '}' ? "Trailing comma" : "Expected property name";
+                    return false;
+                }
+                if (!jc_tape_string(t, ptr)) return false;
+                if (!skip_char(ptr, end, ':')) {
+                    *error = "Expected :";
+                    return false;
+                }
+            } else if (members) {
+                *ptr = jc_skip_ws(*ptr, end);
+                if (*ptr < end && **ptr == ']') {
+                    *error = "Trailing comma";
+                    return false;
+                }
+            }
+            if (!jc_tape_value(t, ptr, depth + 1)) return false;
+            members++;
+            if (skip_char(ptr, end, ',')) continue;
+            if (skip_char(ptr, end, close)) break;
+            *error = *ptr >= end ? "Unexpected end of input" : c == '{' ? "Expected ," : "Expected , or ]";
+            return false;
+        }
+    }
+    if (!jc_tape_push(t, JC_TAPE(close, open_offset))) return false;
+    if (members > 0xFFFFFF) members = 0xFFFFFF;
+    t->words[open_pos] = JC_TAPE(c, ((uint64_t)members << 32) | (uint64_t)t->count);
+    return true;
+}
+
+// Parse any JSON document into a tape stored in arena. On failure the
+// arena keeps what was used so far; jc_arena_reset() reclaims it.
+bool jc_doc_parse(jc_doc* doc, const char* json, size_t len, jc_arena* arena, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    if (!arena) {
+        *error = "No arena for document";
+        return false;
+    }
+    if (len > UINT32_MAX) {
+        *error = "Document too large";
+        return false;
+    }
+    jc_tape t = {arena, NULL, 0, 0, json, json + len, error};
+    const char* ptr = json;
+    if (!jc_tape_value(&t, &ptr, 0)) return false;
+    if (!is_end(ptr, t.end)) {
+        *error = "Unexpected content after value";
+        return false;
+    }
+    // Give back the unused tail of the tape
+    jc_arena_grow(arena, t.words, t.cap * sizeof(uint64_t), t.count * sizeof(uint64_t));
+    doc->json = json;
+    doc->len = len;
+    doc->tape = t.words;
+    doc->count = t.count;
+    return true;
+}
+
+// Cursor at the document's top-level value
+jc_cursor jc_doc_root(const jc_doc* doc) {
+    jc_cursor c = {doc, 0};
+    return c;
+}
+
+// Type at the cursor as a JsonMap type letter: 'o' object, 'a' array,
+// 's' string, 'I' int64, 'U' uint64 beyond INT64_MAX, 'd' double,
+// 'b' boolean, 'n' null; 0 at the end of a container
+char jc_cursor_type(jc_cursor c) {
+    if (c.pos >= c.doc->count) return 0;
+    switch (JC_TAPE_TAG(c.doc->tape[c.pos])) {
+        case '{': return 'o';
+        case '[': return 'a';
+        case '"': return 's';
+        case 'l': return 'I';
+        case 'u': return 'U';
+        case 'd': return 'd';
+        case 't': case 'f': return 'b';
+        case 'n': return 'n';
+        default: return 0;
+    }
+}
+
+// Next value in the same container (for objects, keys and values
+// alternate), skipping any nested containers in O(1)
+jc_cursor jc_cursor_next(jc_cursor c) {
+    if (c.pos >= c.doc->count) return c;
+    uint64_t word = c.doc->tape[c.pos];
+    switch (JC_TAPE_TAG(word)) {
+        case '{': case '[': c.pos = (size_t)(uint32_t)word; break;
+        case '"': case 'l': case 'u': case 'd': c.pos += 2; break;
+        case 't': case 'f': case 'n': c.pos += 1; break;
+        default: break;
+    }
+    return c;
+}
+
+// First element of an array, or first key of an object
+jc_cursor jc_cursor_first(jc_cursor c) {
+    char type = jc_cursor_type(c);
+    if (type == 'o' || type == 'a') {
+        c.pos++;
+    } else {
+        c.pos = c.doc->count;
+    }
+    return c;
+}
+
+// Members of an object or elements of an array
+size_t jc_cursor_count(jc_cursor c) {
+    char type = jc_cursor_type(c);
+    if (type != 'o' && type != 'a') return 0;
+    size_t count = (size_t)((c.doc->tape[c.pos] >> 32) & 0xFFFFFF);
+    if (count == 0xFFFFFF) {
+        // Saturated; count by walking
+        count = 0;
+        for (jc_cursor e = jc_cursor_first(c); jc_cursor_type(e); e = jc_cursor_next(e)) {
+            count++;
+            if (type == 'o') e = jc_cursor_next(e);
+        }
+    }
+    return count;
+}
+
+// Value of the member of an object with the given key, or an end cursor.
+// Keys with escapes are decoded before comparing, which limits them to
+// JC_KEY_MAX - 1 bytes like jc_scan_key().
+jc_cursor jc_cursor_find(jc_cursor c, const char* key) {
+    if (jc_cursor_type(c) != 'o') {
+        c.pos = c.doc->count;
+        return c;
+    }
+    size_t len = strlen(key);
+    char decoded[JC_KEY_MAX];
+    jc_cursor k = jc_cursor_first(c);
+    while (jc_cursor_type(k) == 's') {
+        const uint64_t* w = c.doc->tape + k.pos;
+        jc_cursor value = jc_cursor_next(k);
+        const char* name = c.doc->json + JC_TAPE_PAYLOAD(w[0]);
+        size_t name_len = (size_t)(w[1] & ~(1ULL << 63));
+        if (w[1] >> 63) {
+            // The tape was validated, so decoding fails only for keys
+            // longer than the buffer
+            const char* p = name;
+            bool escaped;
+            char* error = NULL;
+            if (!jc_scan_string_slow(&p, c.doc->json + c.doc->len, decoded, JC_KEY_MAX, &name_len, &escaped,
+                                     &error)) {
+                name_len = SIZE_MAX;
+            }
+            name = decoded;
+        }
+        if (name_len == len && memcmp(name, key, len) == 0) return value;
+        k = jc_cursor_next(value);
+    }
+    return k;
+}
+
+// Element i of an array, or an end cursor
+jc_cursor jc_cursor_at(jc_cursor c, size_t i) {
+    if (jc_cursor_type(c) != 'a') {
+        c.pos = c.doc->count;
+        return c;
+    }
+    jc_cursor e = jc_cursor_first(c);
+    while (i-- && jc_cursor_type(e)) e = jc_cursor_next(e);
+    return e;
+}
+
+bool jc_cursor_str(jc_cursor c, jc_str* out) {
+    if (jc_cursor_type(c) != 's') return false;
+    const uint64_t* w = c.doc->tape + c.pos;
+    out->ptr = c.doc->json + JC_TAPE_PAYLOAD(w[0]);
+    out->len = (size_t)(w[1] & ~(1ULL << 63));
+    out->escaped = (w[1] >> 63) != 0;
+    return true;
+}
+
+bool jc_cursor_int64(jc_cursor c, int64_t* out) {
+    if (jc_cursor_type(c) != 'I') return false;
+    *out = (int64_t)c.doc->tape[c.pos + 1];
+    return true;
+}
+
+bool jc_cursor_uint64(jc_cursor c, uint64_t* out) {
+    char type = jc_cursor_type(c);
+    if (type == 'U' || (type == 'I' && (int64_t)c.doc->tape[c.pos + 1] >= 0)) {
+        *out = c.doc->tape[c.pos + 1];
+        return true;
+    }
+    return false;
+}
+
+// Any number, converted to double
+bool jc_cursor_double(jc_cursor c, double* out) {
+    uint64_t bits;
+    switch (jc_cursor_type(c)) {
+        case 'd':
+            bits = c.doc->tape[c.pos + 1];
+            memcpy(out, &bits, sizeof(*out));
+            return true;
+        case 'I': *out = (double)(int64_t)c.doc->tape[c.pos + 1]; return true;
+        case 'U': *out = (double)c.doc->tape[c.pos + 1]; return true;
+        default: return false;
+    }
+}
+
+bool jc_cursor_bool(jc_cursor c, bool* out) {
+    if (jc_cursor_type(c) != 'b') return false;
+    *out = JC_TAPE_TAG(c.doc->tape[c.pos]) == 't';
+    return true;
+}
+
+// Parse the object at the cursor into the struct at base with a compiled
+// schema, as parse_json_ex() would. The object is read again from the
+// input, so typed fields get exactly the same conversions and checks.
+bool jc_cursor_bind(jc_cursor c, const jc_schema* schema, void* base, const jc_options* opts,
+                    char** error) {
+    if (jc_cursor_type(c) != 'o') {
+        *error = "Expected object";
+        return false;
+    }
+    if (!schema) {
+        *error = "NULL schema";
+        return false;
+    }
+    if (schema->relative && !base) {
+        *error = "NULL destination";
+        return false;
+    }
+    // The close word records where the object starts in the input
+    size_t close = (size_t)(uint32_t)c.doc->tape[c.pos] - 1;
+    const char* ptr = c.doc->json + JC_TAPE_PAYLOAD(c.doc->tape[close]);
+    char key[JC_KEY_MAX];
+    jc_ctx ctx = jc_ctx_init(c.doc->json + c.doc->len, error, c.doc->json);
+    ctx.key = key;
+    if (opts) {
+        ctx.scratch = opts->scratch;
+        ctx.arena = opts->arena;
+        ctx.intern = opts->intern;
+    }
+    return parse_object(&ctx, &ptr, schema->maps, schema->count, schema, base, false);
+}
+
+// Step to the next element of an array whose '[' has been read. Returns 1
+// at an element, 0 after the closing bracket, or -1 on error.
+static inline int jc_next_element(jc_ctx* ctx, const char** ptr, bool first) {
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    if (skip_char(ptr, end, ']')) return 0;
+    if (!first) {
+        if (!skip_char(ptr, end, ',')) {
+            *error = *ptr >= end ? "Unexpected end of input" : "Expected , or ]";
+            return -1;
+        }
+        if (skip_char(ptr, end, ']')) {
+            *error = "Trailing comma";
+            return -1;
+        }
+    }
+    if (*ptr >= end) {
+        *error = "Unexpected end of input";
+        return -1;
+    }
+    return 1;
+}
+
+// Check any value against the JSON grammar alone
+static bool jc_check_any(jc_ctx* ctx, const char** ptr) {
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    *ptr = jc_skip_ws(*ptr, end);
+    if (*ptr >= end) {
+        *error = "Unexpected end of input";
+        return false;
+    }
+    char c = **ptr;
+    if (c == '"') {
+        size_t len;
+        bool escaped;
+        (*ptr)++;
+        return jc_scan_string(ptr, end, NULL, SIZE_MAX, &len, &escaped, error);
+    }
+    if (c == 't' || c == 'f' || c == 'n') {
+        const char* word = c == 't' ? "true" : c == 'f' ? "false" : "null";
+        size_t n = strlen(word);
+        if ((size_t)(end - *ptr) < n || memcmp(*ptr, word, n) != 0) {
+            *error = "Invalid value";
+            return false;
+        }
+        *ptr += n;
+        return true;
+    }
+    if (c != '{' && c != '[') {
+        jc_decimal dec;
+        if (!jc_scan_decimal(ptr, end, &dec)) {
+            *error = "Invalid value";
+            return false;
+        }
+        return true;
+    }
+
+    if (ctx->depth >= JC_DOC_MAX_DEPTH) {
+        *error = "Nesting too deep";
+        return false;
+    }
+    (*ptr)++;
+    jc_enter(ctx);
+    bool first = true;
+    int step;
+    if (c == '{') {
+        const char* key;
+        size_t key_len;
+        while ((step = jc_next_key(ctx, ptr, first, &key, &key_len)) > 0) {
+            if (!jc_check_any(ctx, ptr)) return false;
+            first = false;
+        }
+    } else {
+        while ((step = jc_next_element(ctx, ptr, first)) > 0) {
+            if (!jc_check_any(ctx, ptr)) return false;
+            first = false;
+        }
+    }
+    if (step < 0) return false;
+    ctx->depth--;
+    return true;
+}
+
+static bool jc_check_object(jc_ctx* ctx, const char** ptr, const JsonMap* maps, size_t count,
+                            const jc_schema* schema, bool nested);
+
+// Check a value against its mapping the way parse_value() would read it
+static bool jc_check_value(jc_ctx* ctx, const char** ptr, const JsonMap* map,
+                           const jc_schema* nested_schema) {
+    char** error = ctx->error;
+    const char* end = ctx->end;
+    *ptr = jc_skip_ws(*ptr, end);
+
+    switch (map->type) {
+        case 'i': {
+            int value;
+            return jc_parse_int(ptr, end, &value, error);
+        }
+        case 'I': {
+            int64_t value;
+            return jc_parse_int64(ptr, end, &value, error);
+        }
+        case 'U': {
+            uint64_t value;
+            return jc_parse_uint64(ptr, end, &value, error);
+        }
+        case 's':
+        case 'S': {
+            // Strings must fit once decoded, as jc_parse_string() stores them
+            size_t len;
+            bool escaped;
+            if (*ptr >= end || **ptr != '"') {
+                *error = "Expected string value";
+                return false;
+            }
+            (*ptr)++;
+            return jc_scan_string(ptr, end, NULL, map->type == 's' ? map->size : SIZE_MAX, &len, &escaped,
+                                  error);
+        }
+        case 'e': {
+            int value;
+            return jc_parse_enum(ctx, ptr, map, &value, nested_schema);
+        }
+        case 'n': {
+            // Any string interns, so leave the table alone
+            const char* str;
+            size_t len;
+            return jc_scan_name(ctx, ptr, &str, &len);
+        }
+        case 'b': {
+            bool value;
+            return jc_parse_bool(ptr, end, &value, error);
+        }
+        case 'd':
+        case 'f': {
+            // Any number that scans converts, so skip the conversion
+            jc_decimal dec;
+            if (!jc_scan_decimal(ptr, end, &dec)) {
+                *error = map->type == 'd' ? "Invalid double value" : "Invalid float value";
+                return false;
+            }
+            return true;
+        }
+        case 'o':
+            if (nested_schema) {
+                return jc_check_object(ctx, ptr, nested_schema->maps, nested_schema->count,
+                                       nested_schema, true);
+            }
+            return jc_check_object(ctx, ptr, map->nested, map->size, NULL, true);
+        case 'a':
+        case 'v':
+        case 'c': {
+            if (*ptr >= end || **ptr != '[') {
+                *error = "Expected array";
+                return false;
+            }
+            (*ptr)++;
+            jc_enter(ctx);
+
+            // Fixed arrays need exactly size elements; the others at most
+            // size, where a variable-length array with size 0 is unbounded
+            const JsonMap* item_map = map->nested;
+            size_t count = 0;
+            int step;
+            while ((step = jc_next_element(ctx, ptr, count == 0)) > 0) {
+                if ((map->type != 'v' || map->size) && count >= map->size) {
+                    *error = "Array too long";
+                    return false;
+                }
+                bool ok;
+                if (map->type == 'c') {
+                    ok = nested_schema ? jc_check_object(ctx, ptr, nested_schema->maps, nested_schema->count,
+                                                         nested_schema, true)
+                                       : jc_check_object(ctx, ptr, item_map->nested, item_map->size, NULL, true);
+                } else {
+                    ok = jc_check_value(ctx, ptr, item_map, nested_schema);
+                }
+                if (!ok) return false;
+                count++;
+            }
+            if (step < 0) return false;
+            if (map->type == 'a' && count < map->size) {
+                *error = "Array too short";
+                return false;
+            }
+            ctx->depth--;
+            return true;
+        }
+        default:
+            *error = "Unknown type";
+            return false;
+    }
+}
+
+// Check an object against its mappings like parse_object(), storing nothing.
+// Values of unknown keys are checked against the grammar.
+static bool jc_check_object(jc_ctx* ctx, const char** ptr, const JsonMap* maps, size_t count,
+                            const jc_schema* schema, bool nested) {
+    char** error = ctx->error;
+    if (!skip_char(ptr, ctx->end, '{')) {
+        *error = nested ? "Expected object" : "Expected {";
+        return false;
+    }
+    jc_bits found;
+    if (!jc_bits_init(&found, count, ctx->scratch, &ctx->allocations)) {
+        *error = "Out of memory";
+        return false;
+    }
+    jc_enter(ctx);
+    uint64_t* words = jc_bits_words(&found);
+    bool first_field = true;
+    const char* key_start;
+    size_t key_len;
+    int step;
+    while ((step = jc_next_key(ctx, ptr, first_field, &key_start, &key_len)) > 0) {
+        int index = schema ? jc_schema_find(schema, key_start, key_len)
+                           : find_mapping(maps, count, key_start, key_len);
+        if (index >= 0) {
+            if (!jc_check_value(ctx, ptr, &maps[index], schema ? schema->nested[index] : NULL)) {
+                goto fail;
+            }
+            words[index / 64] |= 1ULL << (index % 64);
+            ctx->matched++;
+        } else {
+            ctx->skipped++;
+            if (!jc_check_any(ctx, ptr)) goto fail;
+        }
+        first_field = false;
+    }
+    if (step < 0) goto fail;
+
+    for (size_t i = 0; i < count; i++) {
+        if (maps[i].required && !(words[i / 64] & (1ULL << (i % 64)))) {
+            *error = nested ? "Missing required field in nested object" : "Missing required field";
+            goto fail;
+        }
+    }
+
+    jc_bits_release(&found);
+    ctx->depth--;
+    return true;
+
+fail:
+    jc_bits_release(&found);
+    return false;
+}
+
+// Check that len bytes of JSON would parse with the schema, without storing
+// anything: the full grammar, escapes and UTF-8 (also inside values no
+// mapping covers), required fields, value types, integer ranges, string
+// lengths and array bounds. No destination, arena or stride is needed.
+bool jc_validate(const jc_schema* schema, const char* json, size_t len, char** error) {
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    if (!schema) {
+        *error = "NULL schema";
+        return false;
+    }
+
+    char key[JC_KEY_MAX];
+    jc_ctx ctx = jc_ctx_init(json + len, error, json);
+    ctx.key = key;
+    const char* ptr = json;
+    if (!jc_check_object(&ctx, &ptr, schema->maps, schema->count, schema, false)) {
+        return false;
+    }
+    if (!is_end(ptr, ctx.end)) {
+        *error = "Unexpected content after }";
+        return false;
+    }
+    return true;
+}
+
+// Error details for one failed NDJSON record
+typedef struct jc_record_error {
+    size_t record;              // Zero-based record index
+    size_t offset;              // Byte offset of the record in the buffer
+    const char* message;        // Parser error message
+} jc_record_error;
+
+// Results of a batch parse. To collect error details, point errors at a
+// caller array and set max_errors before the call.
+typedef struct jc_ndjson_stats {
+    size_t records;             // Records read (non-blank lines)
+    size_t failed;              // Records that failed to parse
+    size_t bytes_consumed;      // Input consumed; resume from here if max_records was hit
+    jc_record_error* errors;    // Optional array for the first failed records
+    size_t max_errors;          // Capacity of errors
+    size_t error_count;         // Entries stored in errors
+} jc_ndjson_stats;
+
+// Per-range state for a batch parse
+typedef struct jc_ndjson_batch {
+    const jc_schema* schema;
+    const char* buf;            // Start of the whole buffer, for offsets
+    const char* begin;          // Range to parse
+    const char* end;
+    char* out;                  // Slot of the first record in this range
+    size_t stride;
+    size_t first_record;        // Index of the first record in this range
+    size_t max_records;         // Records this range may parse
+    bool compact;               // Reuse failed records' slots, so out holds only parsed ones
+    size_t records;
+    size_t failed;
+    const char* stop;           // End of the last record parsed
+    jc_record_error* errors;
+    size_t max_errors;
+    size_t error_count;
+} jc_ndjson_batch;
+
+// Check whether [p, end) holds nothing but whitespace
+static bool jc_is_blank(const char* p, const char* end) {
+    return jc_skip_ws(p, end) == end;
+}
+
+// Parse the records of one range, one line at a time
+static void jc_ndjson_run(jc_ndjson_batch* batch) {
+    jc_scratch scratch = {0};
+    jc_options opts = {&scratch, NULL, NULL, NULL, false, NULL};
+    const char* p = batch->begin;
+    batch->stop = p;
+    while (p < batch->end && batch->records < batch->max_records) {
+        const char* line_end = memchr(p, '\n', batch->end - p);
+        if (!line_end) line_end = batch->end;
+        const char* next = line_end < batch->end ? line_end + 1 : line_end;
+
+        if (!jc_is_blank(p, line_end)) {
+            char* error = NULL;
+            size_t slot = batch->records - (batch->compact ? batch->failed : 0);
+            void* dst = batch->out + slot * batch->stride;
+            if (!jc_parse_document(batch->schema, dst, p, line_end, &opts, &error)) {
+                if (batch->compact) memset(dst, 0, batch->stride);
+                if (batch->error_count < batch->max_errors) {
+                    jc_record_error* err = &batch->errors[batch->error_count++];
+                    err->record = batch->first_record + batch->records;
+                    err->offset = p - batch->buf;
+                    err->message = error;
+                }
+                batch->failed++;
+            }
+            batch->records++;
+            batch->stop = next;
+        }
+        p = next;
+    }
+    if (p >= batch->end) batch->stop = batch->end;
+    jc_scratch_free(&scratch);
+}
+
+// Parse newline-delimited JSON from buf into out_array, one record per
+// non-blank line. Record i is written to out_array + i * stride with a
+// schema compiled by jc_schema_compile_offsets(). A record that fails is
+// counted and reported in stats, and parsing continues with the next line;
+// its slot is left partially written. Returns the number of records read.
+size_t jc_parse_ndjson(const jc_schema* schema, const char* buf, size_t len, void* out_array,
+                       size_t stride, size_t max_records, jc_ndjson_stats* stats) {
+    if (stats) {
+        stats->records = stats->failed = stats->bytes_consumed = stats->error_count = 0;
+    }
+    if (!schema || !schema->relative || !buf || !out_array) return 0;
+
+    jc_ndjson_batch batch = {0};
+    batch.schema = schema;
+    batch.buf = buf;
+    batch.begin = buf;
+    batch.end = buf + len;
+    batch.out = out_array;
+    batch.stride = stride;
+    batch.max_records = max_records;
+    if (stats && stats->errors) {
+        batch.errors = stats->errors;
+        batch.max_errors = stats->max_errors;
+    }
+    jc_ndjson_run(&batch);
+
+    if (stats) {
+        stats->records = batch.records;
+        stats->failed = batch.failed;
+        stats->bytes_consumed = batch.stop - buf;
+        stats->error_count = batch.error_count;
+    }
+    return batch.records;
+}
+
+#if defined(JC_THREADS)
+#include <pthread.h>
+
+// Count the records (non-blank lines) in [p, end)
+static size_t jc_ndjson_count(const char* p, const char* end) {
+    size_t count = 0;
+    while (p < end) {
+        const char* line_end = memchr(p, '\n', end - p);
+        if (!line_end) line_end = end;
+        if (!jc_is_blank(p, line_end)) count++;
+        p = line_end + 1;
+    }
+    return count;
+}
+
+static void* jc_ndjson_count_worker(void* arg) {
+    jc_ndjson_batch* batch = arg;
+    batch->records = jc_ndjson_count(batch->begin, batch->end);
+    return NULL;
+}
+
+static void* jc_ndjson_parse_worker(void* arg) {
+    jc_ndjson_run(arg);
+    return NULL;
+}
+
+// Run fn on each of n tasks of size bytes, using the calling thread for
+// the first one
+static void jc_run_workers(void* tasks, size_t size, unsigned n, void* (*fn)(void*)) {
+    pthread_t tids[64];
+    bool started[64] = {false};
+    for (unsigned i = 1; i < n; i++) {
+        void* task = (char*)tasks + i * size;
+        started[i] = pthread_create(&tids[i], NULL, fn, task) == 0;
+        if (!started[i]) fn(task);
+    }
+    fn(tasks);
+    for (unsigned i = 1; i < n; i++) {
+        if (started[i]) pthread_join(tids[i], NULL);
+    }
+}
+
+// Multi-threaded jc_parse_ndjson() using up to 64 threads. The buffer is
+// split on newline boundaries into one range per thread. Record indices,
+// output slots and the order of reported errors match the serial call.
+size_t jc_parse_ndjson_mt(const jc_schema* schema, const char* buf, size_t len, void* out_array,
+                          size_t stride, size_t max_records, unsigned threads,
+                          jc_ndjson_stats* stats) {
+    if (threads > 64) threads = 64;
+    if (threads > len / 4096) threads = (unsigned)(len / 4096);
+    if (threads <= 1) {
+        return jc_parse_ndjson(schema, buf, len, out_array, stride, max_records, stats);
+    }
+    if (stats) {
+        stats->records = stats->failed = stats->bytes_consumed = stats->error_count = 0;
+    }
+    if (!schema || !schema->relative || !out_array) return 0;
+
+    // Each range collects its own errors so they can be merged in order
+    size_t max_errors = (stats && stats->errors) ? stats->max_errors : 0;
+    jc_ndjson_batch batches[64];
+    memset(batches, 0, sizeof(batches));
+    jc_record_error* errors = NULL;
+    if (max_errors) {
+        errors = JC_CALLOC(threads * max_errors, sizeof(jc_record_error));
+        if (!errors) {
+            return jc_parse_ndjson(schema, buf, len, out_array, stride, max_records, stats);
+        }
+    }
+
+    // Split on newline boundaries
+    const char* end = buf + len;
+    const char* p = buf;
+    for (unsigned i = 0; i < threads; i++) {
+        const char* split = (i == threads - 1) ? end : buf + len / threads * (i + 1);
+        if (split < p) split = p;
+        if (split < end) {
+            const char* nl = memchr(split, '\n', end - split);
+            split = nl ? nl + 1 : end;
+        }
+        batches[i].begin = p;
+        batches[i].end = split;
+        p = split;
+    }
+
+    // Count records per range to find each range's first output slot
+    jc_run_workers(batches, sizeof(batches[0]), threads, jc_ndjson_count_worker);
+    size_t total = 0;
+    for (unsigned i = 0; i < threads; i++) {
+        size_t count = batches[i].records;
+        batches[i].schema = schema;
+        batches[i].buf = buf;
+        batches[i].out = (char*)out_array + total * stride;
+        batches[i].stride = stride;
+        batches[i].first_record = total;
+        batches[i].max_records = total < max_records ? max_records - total : 0;
+        batches[i].records = 0;
+        batches[i].errors = errors ? errors + i * max_errors : NULL;
+        batches[i].max_errors = max_errors;
+        total += count;
+    }
+
+    jc_run_workers(batches, sizeof(batches[0]), threads, jc_ndjson_parse_worker);
+
+    size_t records = 0;
+    size_t failed = 0;
+    size_t error_count = 0;
+    const char* stop = buf;
+    for (unsigned i = 0; i < threads; i++) {
+        records += batches[i].records;
+        failed += batches[i].failed;
+        if (batches[i].records) stop = batches[i].stop;
+        for (size_t e = 0; e < batches[i].error_count && error_count < max_errors; e++) {
+            stats->errors[error_count++] = batches[i].errors[e];
+        }
+    }
+    if (total <= max_records) stop = end;
+
+    if (stats) {
+        stats->records = records;
+        stats->failed = failed;
+        stats->bytes_consumed = stop - buf;
+        stats->error_count = error_count;
+    }
+    JC_FREE(errors);
+    return records;
+}
+
+#ifndef JC_ARRAY_BATCH
+#define JC_ARRAY_BATCH 16           // Elements a worker takes from its own range at a time
+#endif
+
+struct jc_array_job;
+
+// One worker of a parallel array parse. Its range of element indices is
+// packed as begin (low 32 bits) and end (high 32 bits): the owner takes
+// batches from the front and idle workers steal the back half, each with
+// one compare-and-swap.
+typedef struct jc_array_worker {
+    struct jc_array_job* job;
+    _Atomic uint64_t range;
+    unsigned id;
+    size_t error_element;       // Lowest element this worker saw fail, or SIZE_MAX
+    const char* error;
+} jc_array_worker;
+
+// Shared state of a parallel array parse
+typedef struct jc_array_job {
+    const jc_schema* schema;
+    const char* json;
+    const jc_index* index;
+    const uint32_t* elements;   // Index entry of each element's '{'
+    size_t root;                // Offset of the array's '['
+    char* out;
+    size_t stride;
+    jc_array_worker* workers;
+    unsigned threads;
+    _Atomic size_t first_error; // Lowest failed element so far; later ones are skipped
+} jc_array_job;
+
+// Take the next batch of the worker's own range
+static bool jc_array_take(jc_array_worker* w, size_t* begin, size_t* end) {
+    uint64_t r = atomic_load_explicit(&w->range, memory_order_acquire);
+    for (;;) {
+        uint32_t b = (uint32_t)r;
+        uint32_t e = (uint32_t)(r >> 32);
+        if (b >= e) return false;
+        uint32_t take = e - b < JC_ARRAY_BATCH ? e - b : JC_ARRAY_BATCH;
+        uint64_t next = ((uint64_t)e << 32) | (b + take);
+        if (atomic_compare_exchange_weak_explicit(&w->range, &r, next, memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *begin = b;
+            *end = b + take;
+            return true;
+        }
+    }
+}
+
+// Move the back half of another worker's range into w's (empty) range
+static bool jc_array_steal(jc_array_worker* w, jc_array_worker* victim) {
+    uint64_t r = atomic_load_explicit(&victim->range, memory_order_acquire);
+    for (;;) {
+        uint32_t b = (uint32_t)r;
+        uint32_t e = (uint32_t)(r >> 32);
+        if (b >= e) return false;
+        uint32_t split = e - (e - b + 1) / 2;
+        uint64_t left = ((uint64_t)split << 32) | b;
+        if (atomic_compare_exchange_weak_explicit(&victim->range, &r, left, memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            atomic_store_explicit(&w->range, ((uint64_t)e << 32) | split, memory_order_release);
+            return true;
+        }
+    }
+}
+
+// Note a failed element, keeping the lowest index
+static void jc_array_fail(jc_array_worker* w, size_t element, const char* error) {
+    if (element < w->error_element) {
+        w->error_element = element;
+        w->error = error;
+    }
+    size_t first = atomic_load_explicit(&w->job->first_error, memory_order_relaxed);
+    while (element < first &&
+           !atomic_compare_exchange_weak_explicit(&w->job->first_error, &first, element,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// Offset of the bracket at index entry i, and of its partner
+static inline size_t jc_entry_offset(const jc_index* index, size_t i) {
+    return (uint32_t)index->entries[i];
+}
+
+static inline size_t jc_entry_partner(const jc_index* index, size_t i) {
+    return (uint32_t)index->entries[index->entries[i] >> 32];
+}
+
+// Check the separator before element i and parse it into its slot
+static void jc_array_element(jc_array_worker* w, jc_scratch* scratch, size_t i) {
+    jc_array_job* job = w->job;
+    size_t entry = job->elements[i];
+    const char* open = job->json + jc_entry_offset(job->index, entry);
+    const char* p = job->json + (i ? jc_entry_partner(job->index, job->elements[i - 1]) : job->root) + 1;
+    p = jc_skip_ws(p, open);
+    if (i) {
+        if (p >= open || *p != ',') {
+            jc_array_fail(w, i, "Expected ,");
+            return;
+        }
+        p = jc_skip_ws(p + 1, open);
+    }
+    if (p != open) {
+        jc_array_fail(w, i, "Expected object");
+        return;
+    }
+
+    const char* close = job->json + jc_entry_partner(job->index, entry);
+    jc_options opts = {scratch, NULL, NULL, NULL, false, NULL};
+    char* error = NULL;
+    if (!jc_parse_document(job->schema, job->out + i * job->stride, open, close + 1, &opts, &error)) {
+        jc_array_fail(w, i, error);
+    }
+}
+
+static void* jc_array_worker_run(void* arg) {
+    jc_array_worker* w = arg;
+    jc_array_job* job = w->job;
+    jc_scratch scratch = {0};
+    for (;;) {
+        size_t begin, end;
+        if (!jc_array_take(w, &begin, &end)) {
+            bool stolen = false;
+            for (unsigned k = 1; k < job->threads && !stolen; k++) {
+                stolen = jc_array_steal(w, &job->workers[(w->id + k) % job->threads]);
+            }
+            if (!stolen) break;
+            continue;
+        }
+        for (size_t i = begin; i < end; i++) {
+            // Elements after a known failure cannot change the result
+            if (i > atomic_load_explicit(&job->first_error, memory_order_relaxed)) break;
+            jc_array_element(w, &scratch, i);
+        }
+    }
+    jc_scratch_free(&scratch);
+    return NULL;
+}
+
+// Parse a document holding one top-level array of objects into consecutive
+// stride-byte slots of out_array, with up to 64 threads. Element
+// boundaries come from a structural index; workers then parse balanced
+// ranges of elements, stealing from each other when they run out. The
+// output matches a serial parse: element i always lands in slot i, and on
+// failure *error_element and *error describe the lowest failing element
+// (the element count for errors after the last one, SIZE_MAX for errors
+// outside the array). The schema must hold offsets.
+bool jc_parse_array_mt(const jc_schema* schema, const char* json, size_t len, void* out_array,
+                       size_t stride, size_t max_elements, unsigned threads, size_t* count,
+                       size_t* error_element, char** error) {
+    *count = 0;
+    *error_element = SIZE_MAX;
+    if (!json) {
+        *error = "NULL input";
+        return false;
+    }
+    if (!schema || !schema->relative || !out_array) {
+        *error = !schema ? "NULL schema" : !out_array ? "NULL destination" : "Schema must hold offsets";
+        return false;
+    }
+    const char* end = json + len;
+    const char* root = jc_skip_ws(json, end);
+    if (root >= end || *root != '[') {
+        *error = "Expected array";
+        return false;
+    }
+
+    jc_index index = {0};
+    if (!jc_index_build(&index, json, len, error)) return false;
+    if (index.count == 0) {
+        *error = len > UINT32_MAX ? "Document too large" : "Unbalanced brackets";
+        jc_index_free(&index);
+        return false;
+    }
+
+    // Walk the root's children by jumping from each element to its partner
+    size_t root_close = jc_entry_partner(&index, 0);
+    size_t n = 0;
+    for (size_t i = 1; i < index.count && jc_entry_offset(&index, i) < root_close;
+         i = (size_t)(index.entries[i] >> 32) + 1) {
+        n++;
+    }
+    uint32_t* elements = n ? JC_MALLOC(n * sizeof(uint32_t)) : NULL;
+    if (n && !elements) {
+        *error = "Out of memory";
+        jc_index_free(&index);
+        return false;
+    }
+    n = 0;
+    for (size_t i = 1; i < index.count && jc_entry_offset(&index, i) < root_close;
+         i = (size_t)(index.entries[i] >> 32) + 1) {
+        elements[n++] = (uint32_t)i;
+    }
+
+    bool ok = true;
+    if (n > max_elements) {
+        *error = "Array too long";
+        *error_element = max_elements;
+        ok = false;
+    }
+
+    if (ok && n) {
+        if (threads > 64) threads = 64;
+        if (threads > n) threads = (unsigned)n;
+        if (threads < 1) threads = 1;
+        jc_array_worker workers[64];
+        jc_array_job job = {schema, json, &index, elements, (size_t)(root - json), out_array, stride,
+                            workers, threads, SIZE_MAX};
+        for (unsigned t = 0; t < threads; t++) {
+            uint64_t begin = n * t / threads;
+            uint64_t finish = n * (t + 1) / threads;
+            workers[t].job = &job;
+            atomic_init(&workers[t].range, (finish << 32) | begin);
+            workers[t].id = t;
+            workers[t].error_element = SIZE_MAX;
+            workers[t].error = NULL;
+        }
+        jc_run_workers(workers, sizeof(workers[0]), threads, jc_array_worker_run);
+        for (unsigned t = 0; t < threads; t++) {
+            if (workers[t].error_element < *error_element) {
+                *error_element = workers[t].error_element;
+                *error = (char*)workers[t].error;
+            }
+        }
+        ok = *error_element == SIZE_MAX;
+    }
+
+    // Only whitespace may follow the last element
+    if (ok) {
+        const char* p = json + (n ? jc_entry_partner(&index, elements[n - 1]) : (size_t)(root - json)) + 1;
+        const char* close = json + root_close;
+        p = jc_skip_ws(p, close);
+        if (p != close) {
+            if (n && *p == ',') {
+                *error = jc_skip_ws(p + 1, close) == close ? "Trailing comma" : "Expected object";
+            } else {
+                *error = n ? "Expected ," : "Expected object";
+            }
+            *error_element = n;
+            ok = false;
+        } else if (!is_end(close + 1, end)) {
+            *error = "Unexpected content after ]";
+            ok = false;
+        }
+    }
+    if (ok) *count = n;
+
+    JC_FREE(elements);
+    jc_index_free(&index);
+    return ok;
+}
+
+#if defined(JC_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(JC_ZSTD)
+#include <zstd.h>
+#endif
+
+#ifndef JC_RING_BUFFER_SIZE
+#define JC_RING_BUFFER_SIZE (1 << 20)  // Bytes per buffer of jc_parse_compressed_stream(), and its longest record
+#endif
+
+// Receives the records of jc_parse_compressed_stream() in file order, one
+// batch at a time: count structs stride bytes apart, the first being
+// parsed record first_record. Records that failed are left out (they are
+// reported only through the stats), so record indices in the stats count
+// them but first_record does not. Fields a record omits are zero. The
+// memory is reused once fn returns. Return false to stop reading.
+typedef bool (*jc_batch_fn)(void* user, void* records, size_t count, size_t first_record);
+
+// Decompressed input of a stream: plain text, gzip or zstd, told apart by
+// their magic bytes
+typedef struct jc_source {
+    FILE* file;
+    char kind;                  // 'p' plain, 'g' gzip, 'z' zstd
+#if defined(JC_ZLIB)
+    gzFile gz;
+#endif
+#if defined(JC_ZSTD)
+    ZSTD_DStream* zstd;
+    ZSTD_inBuffer in;           // Compressed bytes read from file
+    size_t in_cap;
+    bool eof;                   // file is exhausted
+    bool pending;               // The last frame is not finished
+#endif
+} jc_source;
+
+static void jc_source_close(jc_source* src) {
+#if defined(JC_ZLIB)
+    if (src->gz) gzclose(src->gz);
+#endif
+#if defined(JC_ZSTD)
+    if (src->zstd) ZSTD_freeDStream(src->zstd);
+    JC_FREE((void*)src->in.src);
+#endif
+    if (src->file) fclose(src->file);
+}
+
+static bool jc_source_open(jc_source* src, const char* path, char** error) {
+    memset(src, 0, sizeof(*src));
+    src->kind = 'p';
+    src->file = fopen(path, "rb");
+    if (!src->file) {
+        *error = "Cannot open file";
+        return false;
+    }
+    unsigned char magic[4] = {0};
+    size_t n = fread(magic, 1, sizeof(magic), src->file);
+    rewind(src->file);
+
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+#if defined(JC_ZLIB)
+        fclose(src->file);
+        src->file = NULL;
+        src->gz = gzopen(path, "rb");
+        if (!src->gz) {
+            *error = "Cannot open file";
+            return false;
+        }
+        gzbuffer(src->gz, 1 << 17);
+        src->kind = 'g';
+#else
+        *error = "gzip input needs JC_ZLIB";
+        jc_source_close(src);
+        return false;
+#endif
+    } else if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#if defined(JC_ZSTD)
+        src->zstd = ZSTD_createDStream();
+        src->in_cap = ZSTD_DStreamInSize();
+        src->in.src = JC_MALLOC(src->in_cap);
+        if (!src->zstd || !src->in.src || ZSTD_isError(ZSTD_initDStream(src->zstd))) {
+            *error = "Out of memory";
+            jc_source_close(src);
+            return false;
+        }
+        src->kind = 'z';
+#else
+        *error = "zstd input needs JC_ZSTD";
+        jc_source_close(src);
+        return false;
+#endif
+    }
+    return true;
+}
+
+// Decompress up to cap bytes into out. Stops short only at the end of the input.
+static bool jc_source_read(jc_source* src, char* out, size_t cap, size_t* got, char** error) {
+    size_t filled = 0;
+    if (src->kind == 'p') {
+        filled = fread(out, 1, cap, src->file);
+        if (filled < cap && ferror(src->file)) {
+            *error = "Cannot read file";
+            return false;
+        }
+    }
+#if defined(JC_ZLIB)
+    while (src->kind == 'g' && filled < cap) {
+        unsigned want = cap - filled > (1u << 30) ? 1u << 30 : (unsigned)(cap - filled);
+        int n = gzread(src->gz, out + filled, want);
+        int status = Z_OK;
+        if (n <= 0) gzerror(src->gz, &status);
+        if (n < 0 || status != Z_OK) {
+            // zlib reports input that ends inside a member as a short read
+            *error = status == Z_BUF_ERROR ? "Truncated gzip data" : "Corrupt gzip data";
+            return false;
+        }
+        if (n == 0) break;
+        filled += (size_t)n;
+    }
+#endif
+#if defined(JC_ZSTD)
+    while (src->kind == 'z' && filled < cap) {
+        if (src->in.pos == src->in.size && !src->eof) {
+            src->in.size = fread((void*)src->in.src, 1, src->in_cap, src->file);
+            src->in.pos = 0;
+            if (src->in.size == 0) {
+                if (ferror(src->file)) {
+                    *error = "Cannot read file";
+                    return false;
+                }
+                src->eof = true;
+            }
+        }
+        size_t before = src->in.pos;
+        ZSTD_outBuffer o = {out + filled, cap - filled, 0};
+        size_t hint = ZSTD_decompressStream(src->zstd, &o, &src->in);
+        if (ZSTD_isError(hint)) {
+            *error = "Corrupt zstd data";
+            return false;
+        }
+        filled += o.pos;
+        // A call that moved nothing says nothing about the current frame
+        if (o.pos || src->in.pos != before) src->pending = hint != 0;
+        if (src->eof && o.pos == 0) {
+            if (src->pending) {
+                *error = "Truncated zstd data";
+                return false;
+            }
+            break;
+        }
+    }
+#endif
+    *got = filled;
+    return true;
+}
+
+// One buffer of the ring: decompressed lines and the records parsed from them
+typedef struct jc_ring_slot {
+    char* data;                 // JC_RING_BUFFER_SIZE bytes
+    size_t len;                 // Bytes of complete lines; a partial last line follows
+    size_t offset;              // Offset of data in the decompressed stream
+    char* records;              // Records parsed from the lines, stride bytes apart
+    size_t records_cap;         // Capacity in records
+    jc_ndjson_batch batch;      // Parse results, with record indices relative to the buffer
+} jc_ring_slot;
+
+// Shared state of a compressed stream parse. Buffer seq lives in slot
+// seq % slot_count: the decompressor fills it once buffer seq - slot_count
+// has been delivered, a parser takes it, and delivers it after buffer seq - 1.
+typedef struct jc_ring {
+    const jc_schema* schema;
+    size_t stride;
+    jc_batch_fn fn;
+    void* user;
+    jc_ndjson_stats* stats;
+    jc_ring_slot* slots;
+    size_t slot_count;
+    size_t filled;              // Buffers handed to parsers
+    size_t taken;               // Buffers taken by parsers
+    size_t delivered;           // Buffers passed to fn
+    size_t records;             // Records read, including failed ones
+    size_t passed;              // Records passed to fn
+    bool done;                  // No more buffers will be filled
+    bool stopped;               // fn asked to stop, or parsing failed
+    const char* error;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;     // Broadcast whenever a counter above moves
+} jc_ring;
+
+// Parse the lines of a buffer into its records, growing them if needed
+static bool jc_ring_parse(jc_ring* ring, jc_ring_slot* slot) {
+    size_t max_errors = (ring->stats && ring->stats->errors) ? ring->stats->max_errors : 0;
+    size_t count = jc_ndjson_count(slot->data, slot->data + slot->len);
+    if (count > slot->records_cap) {
+        char* grown = JC_REALLOC(slot->records, count * ring->stride);
+        if (!grown) return false;
+        slot->records = grown;
+        slot->records_cap = count;
+    }
+    jc_record_error* errors = slot->batch.errors;
+    if (max_errors && !errors) {
+        errors = JC_MALLOC(max_errors * sizeof(jc_record_error));
+        if (!errors) return false;
+    }
+    jc_ndjson_batch batch = {0};
+    batch.schema = ring->schema;
+    batch.buf = slot->data;
+    batch.begin = slot->data;
+    batch.end = slot->data + slot->len;
+    batch.out = slot->records;
+    batch.stride = ring->stride;
+    batch.max_records = count;
+    batch.compact = true;
+    batch.errors = errors;
+    batch.max_errors = max_errors;
+    slot->batch = batch;
+    // The slot's records hold the last buffer's values, so omitted fields
+    // must be cleared
+    memset(slot->records, 0, count * ring->stride);
+    jc_ndjson_run(&slot->batch);
+    return true;
+}
+
+// Hand a parsed buffer to fn and add its results to the stats
+static bool jc_ring_deliver(jc_ring* ring, jc_ring_slot* slot) {
+    jc_ndjson_batch* batch = &slot->batch;
+    jc_ndjson_stats* stats = ring->stats;
+    if (stats) {
+        stats->records += batch->records;
+        stats->failed += batch->failed;
+        stats->bytes_consumed = slot->offset + slot->len;
+        size_t max_errors = stats->errors ? stats->max_errors : 0;
+        for (size_t i = 0; i < batch->error_count && stats->error_count < max_errors; i++) {
+            jc_record_error err = batch->errors[i];
+            err.record += ring->records;
+            err.offset += slot->offset;
+            stats->errors[stats->error_count++] = err;
+        }
+    }
+    ring->records += batch->records;
+    size_t parsed = batch->records - batch->failed;
+    size_t first = ring->passed;
+    ring->passed += parsed;
+    return !ring->fn || !parsed || ring->fn(ring->user, slot->records, parsed, first);
+}
+
+// Parser thread: take buffers in turn, parse them, and deliver them in order
+static void* jc_ring_worker(void* arg) {
+    jc_ring* ring = arg;
+    pthread_mutex_lock(&ring->lock);
+    for (;;) {
+        while (ring->taken == ring->filled && !ring->done && !ring->stopped) {
+            pthread_cond_wait(&ring->changed, &ring->lock);
+        }
+        if (ring->stopped || ring->taken == ring->filled) break;
+        size_t seq = ring->taken++;
+        jc_ring_slot* slot = &ring->slots[seq % ring->slot_count];
+        pthread_mutex_unlock(&ring->lock);
+
+        bool parsed = jc_ring_parse(ring, slot);
+
+        pthread_mutex_lock(&ring->lock);
+        while (ring->delivered != seq && !ring->stopped) pthread_cond_wait(&ring->changed, &ring->lock);
+        if (ring->stopped) break;
+        if (!parsed) {
+            ring->error = "Out of memory";
+            ring->stopped = true;
+        } else {
+            // Only this thread may deliver now, so fn runs without the lock
+            pthread_mutex_unlock(&ring->lock);
+            bool more = jc_ring_deliver(ring, slot);
+            pthread_mutex_lock(&ring->lock);
+            if (!more) ring->stopped = true;
+        }
+        ring->delivered++;
+        pthread_cond_broadcast(&ring->changed);
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return NULL;
+}
+
+// Decompress the input into the ring, cutting each buffer after its last
+// newline and carrying the partial line into the next buffer
+static bool jc_ring_fill(jc_ring* ring, jc_source* src, char** error) {
+    const size_t cap = JC_RING_BUFFER_SIZE;
+    jc_ring_slot* prev = NULL;
+    size_t carry = 0;
+    size_t offset = 0;
+    for (;;) {
+        pthread_mutex_lock(&ring->lock);
+        while (ring->filled - ring->delivered >= ring->slot_count && !ring->stopped) {
+            pthread_cond_wait(&ring->changed, &ring->lock);
+        }
+        bool stopped = ring->stopped;
+        pthread_mutex_unlock(&ring->lock);
+        if (stopped) return true;
+
+        jc_ring_slot* slot = &ring->slots[ring->filled % ring->slot_count];
+        if (carry) memmove(slot->data, prev->data + prev->len, carry);
+        size_t got;
+        if (!jc_source_read(src, slot->data + carry, cap - carry, &got, error)) return false;
+        size_t avail = carry + got;
+        bool last = got < cap - carry;
+
+        // At the end of the input, a last line without a newline still counts
+        size_t len = avail;
+        if (!last) {
+            while (len > 0 && slot->data[len - 1] != '\n') len--;
+            if (len == 0) {
+                *error = "Record too long";
+                return false;
+            }
+        }
+        slot->len = len;
+        slot->offset = offset;
+        offset += len;
+        carry = avail - len;
+        prev = slot;
+
+        pthread_mutex_lock(&ring->lock);
+        if (len) ring->filled++;
+        pthread_cond_broadcast(&ring->changed);
+        pthread_mutex_unlock(&ring->lock);
+        if (last) return true;
+    }
+}
+
+// Parse an NDJSON file, plain or compressed with gzip (JC_ZLIB) or zstd
+// (JC_ZSTD), in a pipeline: the calling thread decompresses into a ring of
+// threads + 2 buffers of JC_RING_BUFFER_SIZE bytes while up to 64 parser
+// threads each parse a whole buffer. Records are parsed like
+// jc_parse_ndjson() with an offset-based schema and handed to fn (which may
+// be NULL) per buffer, in file order. Memory stays bounded by the ring,
+// whatever the file size; a record longer than a buffer is an error.
+// Failed records are left out of the batches, counted in stats with
+// offsets into the decompressed text, and do not stop the parse. Returns false if the input cannot be
+// read or decompressed; records delivered until then remain valid.
+bool jc_parse_compressed_stream(const char* path, const jc_schema* schema, size_t stride,
+                                jc_batch_fn fn, void* user, unsigned threads, jc_ndjson_stats* stats,
+                                char** error) {
+    if (stats) {
+        stats->records = stats->failed = stats->bytes_consumed = stats->error_count = 0;
+    }
+    if (!schema || !schema->relative || !path) {
+        *error = !schema ? "NULL schema" : !path ? "NULL path" : "Schema must hold offsets";
+        return false;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > 64) threads = 64;
+
+    jc_source src;
+    if (!jc_source_open(&src, path, error)) return false;
+
+    jc_ring ring = {0};
+    ring.schema = schema;
+    ring.stride = stride;
+    ring.fn = fn;
+    ring.user = user;
+    ring.stats = stats;
+    ring.slot_count = threads + 2;
+    ring.slots = JC_CALLOC(ring.slot_count, sizeof(jc_ring_slot));
+    bool ok = ring.slots != NULL;
+    for (size_t i = 0; ok && i < ring.slot_count; i++) {
+        ring.slots[i].data = JC_MALLOC(JC_RING_BUFFER_SIZE);
+        ok = ring.slots[i].data != NULL;
+    }
+    if (!ok) {
+        *error = "Out of memory";
+    } else {
+        pthread_mutex_init(&ring.lock, NULL);
+        pthread_cond_init(&ring.changed, NULL);
+        pthread_t tids[64];
+        unsigned started = 0;
+        while (started < threads && pthread_create(&tids[started], NULL, jc_ring_worker, &ring) == 0) {
+            started++;
+        }
+        if (started == 0) {
+            *error = "Cannot start threads";
+            ok = false;
+        } else {
+            ok = jc_ring_fill(&ring, &src, error);
+        }
+
+        // Stop the parsers on failure, or let them drain the ring
+        pthread_mutex_lock(&ring.lock);
+        ring.done = true;
+        if (!ok) ring.stopped = true;
+        pthread_cond_broadcast(&ring.changed);
+        pthread_mutex_unlock(&ring.lock);
+        for (unsigned t = 0; t < started; t++) pthread_join(tids[t], NULL);
+        if (ok && ring.error) {
+            *error = (char*)ring.error;
+            ok = false;
+        }
+        pthread_cond_destroy(&ring.changed);
+        pthread_mutex_destroy(&ring.lock);
+    }
+
+    for (size_t i = 0; ring.slots && i < ring.slot_count; i++) {
+        JC_FREE(ring.slots[i].data);
+        JC_FREE(ring.slots[i].records);
+        JC_FREE(ring.slots[i].batch.errors);
+    }
+    JC_FREE(ring.slots);
+    jc_source_close(&src);
+    return ok;
+}
+#endif
+
+#ifndef JC_STREAM_MAX_DEPTH
+#define JC_STREAM_MAX_DEPTH 64      // Deepest object/array nesting a stream accepts
+#endif
+#ifndef JC_STREAM_TOKEN_MAX
+#define JC_STREAM_TOKEN_MAX 256     // Longest key, number or literal a stream buffers
+#endif
+
+// One open object or array in a stream
+typedef struct jc_stream_frame {
+    const JsonMap* maps;        // Object: mappings; array: item mapping
+    size_t count;               // Object: mapping count; array: capacity
+    const jc_schema* schema;    // Compiled index of the object or of array items, if any
+    char* base;                 // Object: base for offsets; array: first element
+    size_t found;               // Object: first bit of its found flags
+    long field;                 // Object: mapping of the current key or -1;
+                                // array: number of elements parsed
+    char kind;                  // 'o' for object, 'a' for array
+    bool relative;              // Object: struct_member holds offsets
+} jc_stream_frame;
+
+// Incremental parser state. Input may be split at any byte, including in
+// the middle of a key, string or number; each field is written to the
+// struct as soon as its value is complete.
+typedef struct jc_stream {
+    const jc_schema* schema;
+    void* base;
+    jc_stream_frame stack[JC_STREAM_MAX_DEPTH];
+    size_t depth;
+    int state;
+    const JsonMap* map;         // Mapping of the value being parsed
+    char* dst;                  // Destination of the value being parsed
+    size_t len;                 // Bytes written to dst so far (strings)
+    bool escape;                // Last byte was a backslash
+    bool in_string;             // Inside a string of a skipped container
+    size_t skip_depth;          // Nesting inside a skipped container
+    char token[JC_STREAM_TOKEN_MAX];
+    size_t token_len;           // Buffered key, number or literal bytes
+    bool token_overflow;        // Key longer than any mapping
+    uint64_t* found_bits;       // Found flags for every open object
+    size_t offset;              // Bytes fed before the current chunk
+    size_t error_offset;        // Input offset where parsing failed
+    char* error;                // Sticky error from a failed feed
+} jc_stream;
+
+enum {
+    JC_ST_BEGIN,                // Before the top-level '{'
+    JC_ST_KEY_OR_END,           // After '{': a key or '}'
+    JC_ST_KEY_START,            // After ',' in an object: a key
+    JC_ST_KEY,                  // Inside a key
+    JC_ST_COLON,                // After a key
+    JC_ST_VALUE,                // Before a value
+    JC_ST_ITEM_OR_END,          // After '[': a value or ']'
+    JC_ST_AFTER_VALUE,          // After a value: ',' or a closing bracket
+    JC_ST_STRING,               // Inside a mapped string
+    JC_ST_NUMBER,               // Inside a mapped number
+    JC_ST_LITERAL,              // Inside a mapped true/false
+    JC_ST_SKIP_SCALAR,          // Inside an unmapped number or literal
+    JC_ST_SKIP_STRING,          // Inside an unmapped string
+    JC_ST_SKIP_NESTED,          // Inside an unmapped object or array
+    JC_ST_DONE                  // After the top-level '}'
+};
+
+// Count the found flags and longest key of a mapping tree
+static void jc_stream_measure(const JsonMap* maps, size_t count, size_t* fields, size_t* key_max) {
+    *fields += count;
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(maps[i].json_key);
+        if (len > *key_max) *key_max = len;
+        if (maps[i].type == 'o') {
+            jc_stream_measure(maps[i].nested, maps[i].size, fields, key_max);
+        } else if (maps[i].type == 'a' && maps[i].nested->type == 'o') {
+            jc_stream_measure(maps[i].nested->nested, maps[i].nested->size, fields, key_max);
+        }
+    }
+}
+
+static bool jc_stream_fail(jc_stream* s, const char* chunk, const char* p, char* message, char** error) {
+    s->error = message;
+    s->error_offset = s->offset + (p - chunk);
+    *error = message;
+    return false;
+}
+
+static bool jc_stream_push_object(jc_stream* s, const JsonMap* maps, size_t count,
+                                  const jc_schema* schema, char* base) {
+    if (s->depth >= JC_STREAM_MAX_DEPTH) return false;
+    size_t found = 0;
+    for (size_t i = s->depth; i > 0; i--) {
+        if (s->stack[i - 1].kind == 'o') {
+            found = s->stack[i - 1].found + s->stack[i - 1].count;
+            break;
+        }
+    }
+    for (size_t i = found; i < found + count; i++) {
+        s->found_bits[i / 64] &= ~(1ULL << (i % 64));
+    }
+    jc_stream_frame* frame = &s->stack[s->depth++];
+    frame->maps = maps;
+    frame->count = count;
+    frame->schema = schema;
+    frame->base = base;
+    frame->found = found;
+    frame->field = -1;
+    frame->kind = 'o';
+    frame->relative = schema && schema->relative;
+    return true;
+}
+
+static bool jc_stream_push_array(jc_stream* s, const JsonMap* item_map, size_t count,
+                                 const jc_schema* item_schema, char* base) {
+    if (s->depth >= JC_STREAM_MAX_DEPTH) return false;
+    jc_stream_frame* frame = &s->stack[s->depth++];
+    frame->maps = item_map;
+    frame->count = count;
+    frame->schema = item_schema;
+    frame->base = base;
+    frame->found = 0;
+    frame->field = 0;
+    frame->kind = 'a';
+    frame->relative = false;
+    return true;
+}
+
+// A value of the innermost open container is complete
+static void jc_stream_value_done(jc_stream* s) {
+    jc_stream_frame* frame = &s->stack[s->depth - 1];
+    if (frame->kind == 'a') {
+        frame->field++;
+    } else if (frame->field >= 0) {
+        size_t bit = frame->found + (size_t)frame->field;
+        s->found_bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+    s->state = JC_ST_AFTER_VALUE;
+}
+
+// Close the innermost container, checking required fields or array length
+static char* jc_stream_close(jc_stream* s) {
+    jc_stream_frame* frame = &s->stack[s->depth - 1];
+    if (frame->kind == 'o') {
+        for (size_t i = 0; i < frame->count; i++) {
+            size_t bit = frame->found + i;
+            if (frame->maps[i].required && !(s->found_bits[bit / 64] & (1ULL << (bit % 64)))) {
+                return s->depth > 1 ? "Missing required field in nested object" : "Missing required field";
+            }
+        }
+    } else if ((size_t)frame->field < frame->count) {
+        return "Array too short";
+    }
+    s->depth--;
+    if (s->depth == 0) {
+        s->state = JC_ST_DONE;
+    } else {
+        jc_stream_value_done(s);
+    }
+    return NULL;
+}
+
+// Error reported when a value does not match its mapping's type
+static char* jc_type_error(char type) {
+    switch (type) {
+        case 'i': case 'I': case 'U': return "Invalid integer value";
+        case 'd': return "Invalid double value";
+        case 'f': return "Invalid float value";
+        case 'b': return "Invalid boolean value";
+        case 's': case 'S': case 'e': case 'n': return "Expected string value";
+        case 'o': return "Expected object";
+        case 'a': case 'v': case 'c': return "Expected array";
+        default: return "Unknown type";
+    }
+}
+
+// Start the value of the current key or array element at byte c.
+// Returns an error message, or NULL with s->state set for the value.
+static char* jc_stream_begin_value(jc_stream* s, char c) {
+    jc_stream_frame* frame = &s->stack[s->depth - 1];
+    const JsonMap* map;
+    char* dst;
+    const jc_schema* nested = NULL;
+    if (frame->kind == 'a') {
+        if ((size_t)frame->field >= frame->count) return "Array too long";
+        map = frame->maps;
+        dst = frame->base + (size_t)frame->field * jc_item_size(map);
+        nested = frame->schema;
+    } else if (frame->field >= 0) {
+        map = &frame->maps[frame->field];
+        dst = frame->relative ? frame->base + (uintptr_t)map->struct_member : map->struct_member;
+        if (frame->schema) nested = frame->schema->nested[frame->field];
+    } else {
+        // Unmapped value: skip it
+        if (c == '"') {
+            s->escape = false;
+            s->state = JC_ST_SKIP_STRING;
+        } else if (c == '{' || c == '[') {
+            s->skip_depth = 0;
+            s->in_string = false;
+            s->state = JC_ST_SKIP_NESTED;
+        } else {
+            s->state = JC_ST_SKIP_SCALAR;
+        }
+        return NULL;
+    }
+
+    s->map = map;
+    s->dst = dst;
+    switch (map->type) {
+        case 's':
+            if (c != '"') return jc_type_error(map->type);
+            s->len = 0;
+            s->escape = false;
+            s->state = JC_ST_STRING;
+            return NULL;
+        case 'i': case 'I': case 'U': case 'd': case 'f':
+            if (c != '-' && !jc_is_digit(c)) return jc_type_error(map->type);
+            s->token_len = 0;
+            s->state = JC_ST_NUMBER;
+            return NULL;
+        case 'b':
+            if (c != 't' && c != 'f') return jc_type_error(map->type);
+            s->token_len = 0;
+            s->state = JC_ST_LITERAL;
+            return NULL;
+        case 'o':
+            if (c != '{') return jc_type_error(map->type);
+            if (nested) {
+                if (!jc_stream_push_object(s, nested->maps, nested->count, nested, dst)) return "Nesting too deep";
+            } else {
+                if (!jc_stream_push_object(s, map->nested, map->size, NULL, dst)) return "Nesting too deep";
+            }
+            s->state = JC_ST_KEY_OR_END;
+            return NULL;
+        case 'a':
+            if (c != '[') return jc_type_error(map->type);
+            if (!jc_stream_push_array(s, map->nested, map->size, nested, dst)) return "Nesting too deep";
+            s->state = JC_ST_ITEM_OR_END;
+            return NULL;
+        case 'v':
+            return "Variable-length arrays cannot be streamed";
+        case 'S':
+            return "String views cannot be streamed";
+        case 'c':
+            return "Columnar arrays cannot be streamed";
+        case 'e':
+            return "Enums cannot be streamed";
+        case 'n':
+            return "Interned strings cannot be streamed";
+        default:
+            return "Unknown type";
+    }
+}
+
+// Convert a buffered number or literal into the pending destination
+static char* jc_stream_finish_token(jc_stream* s) {
+    char* error = NULL;
+    jc_ctx ctx = jc_ctx_init(s->token + s->token_len, &error, s->token);
+    const char* ptr = s->token;
+    if (!parse_value(&ctx, &ptr, s->map, s->dst, NULL)) return error;
+    if (ptr != ctx.end) return jc_type_error(s->map->type);
+    jc_stream_value_done(s);
+    return NULL;
+}
+
+static inline bool jc_is_number_char(char c) {
+    return jc_is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// Start an incremental parse into the struct at base (ignored for schemas
+// compiled from absolute pointers). Every successful init must be paired
+// with jc_stream_finish(), which releases the stream's resources.
+bool jc_stream_init(jc_stream* stream, const jc_schema* schema, void* base, char** error) {
+    if (!schema) {
+        *error = "NULL schema";
+        return false;
+    }
+    if (schema->relative && !base) {
+        *error = "NULL destination";
+        return false;
+    }
+    size_t fields = 0;
+    size_t key_max = 0;
+    jc_stream_measure(schema->maps, schema->count, &fields, &key_max);
+    if (key_max >= JC_STREAM_TOKEN_MAX) {
+        *error = "Key too long for streaming";
+        return false;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    stream->schema = schema;
+    stream->base = base;
+    stream->state = JC_ST_BEGIN;
+    stream->found_bits = JC_CALLOC(fields / 64 + 1, sizeof(uint64_t));
+    if (!stream->found_bits) {
+        *error = "Out of memory";
+        return false;
+    }
+    return true;
+}
+
+// Feed the next chunk of input. Returns false on a parse error; the error
+// is sticky and its input offset is kept in stream->error_offset.
+bool jc_stream_feed(jc_stream* stream, const char* chunk, size_t len, char** error) {
+    jc_stream* s = stream;
+    if (s->error) {
+        *error = s->error;
+        return false;
+    }
+
+    const char* p = chunk;
+    const char* end = chunk + len;
+    while (p < end) {
+        switch (s->state) {
+            case JC_ST_BEGIN:
+                p = jc_skip_ws(p, end);
+                if (p == end) break;
+                if (*p != '{') return jc_stream_fail(s, chunk, p, "Expected {", error);
+                jc_stream_push_object(s, s->schema->maps, s->schema->count, s->schema, s->base);
+                s->state = JC_ST_KEY_OR_END;
+                p++;
+                break;
+
+            case JC_ST_KEY_OR_END:
+            case JC_ST_KEY_START:
+                p = jc_skip_ws(p, end);
+                if (p == end) break;
+                if (*p == '}') {
+                    if (s->state == JC_ST_KEY_START) return jc_stream_fail(s, chunk, p, "Trailing comma", error);
+                    char* message = jc_stream_close(s);
+                    if (message) return jc_stream_fail(s, chunk, p, message, error);
+                    p++;
+                    break;
+                }
+                if (*p != '"') return jc_stream_fail(s, chunk, p, "Expected property name", error);
+                s->token_len = 0;
+                s->token_overflow = false;
+                s->escape = false;
+                s->state = JC_ST_KEY;
+                p++;
+                break;
+
+            case JC_ST_KEY: {
+                // The key is buffered as written and decoded once complete
+                if (s->escape) {
+                    s->escape = false;
+                    if (s->token_len < JC_STREAM_TOKEN_MAX) s->token[s->token_len++] = *p;
+                    else s->token_overflow = true;
+                    p++;
+                    break;
+                }
+                const char* q = jc_scan_special(p, end);
+                size_t n = q - p;
+                if (s->token_len + n > JC_STREAM_TOKEN_MAX) {
+                    s->token_overflow = true;
+                    n = JC_STREAM_TOKEN_MAX - s->token_len;
+                }
+                memcpy(s->token + s->token_len, p, n);
+                s->token_len += n;
+                p = q;
+                if (p == end) break;
+                if (*p != '"') {
+                    if ((unsigned char)*p < 0x20) {
+                        return jc_stream_fail(s, chunk, p, "Control character in string", error);
+                    }
+                    s->escape = *p == '\\';
+                    if (s->token_len < JC_STREAM_TOKEN_MAX) s->token[s->token_len++] = *p;
+                    else s->token_overflow = true;
+                    p++;
+                    break;
+                }
+                jc_stream_frame* frame = &s->stack[s->depth - 1];
+                int index = -1;
+                if (!s->token_overflow) {
+                    if (!jc_utf8_valid(s->token, s->token + s->token_len)) {
+                        return jc_stream_fail(s, chunk, p, "Invalid UTF-8", error);
+                    }
+                    char* message = NULL;
+                    if (memchr(s->token, '\\', s->token_len) &&
+                        !jc_unescape(s->token, s->token + s->token_len, s->token, &s->token_len, &message)) {
+                        return jc_stream_fail(s, chunk, p, message, error);
+                    }
+                    index = frame->schema ? jc_schema_find(frame->schema, s->token, s->token_len)
+                                          : find_mapping(frame->maps, frame->count, s->token, s->token_len);
+                }
+                frame->field = index;
+                s->state = JC_ST_COLON;
+                p++;
+                break;
+            }
+
+            case JC_ST_COLON:
+                p = jc_skip_ws(p, end);
+                if (p == end) break;
+                if (*p != ':') return jc_stream_fail(s, chunk, p, "Expected :", error);
+                s->state = JC_ST_VALUE;
+                p++;
+                break;
+
+            case JC_ST_ITEM_OR_END:
+            case JC_ST_VALUE: {
+                p = jc_skip_ws(p, end);
+                if (p == end) break;
+                if (s->state == JC_ST_ITEM_OR_END && *p == ']') {
+                    char* message = jc_stream_close(s);
+                    if (message) return jc_stream_fail(s, chunk, p, message, error);
+                    p++;
+                    break;
+                }
+                char* message = jc_stream_begin_value(s, *p);
+                if (message) return jc_stream_fail(s, chunk, p, message, error);
+                // Numbers and literals keep their first byte
+                if (s->state != JC_ST_NUMBER && s->state != JC_ST_LITERAL &&
+                    s->state != JC_ST_SKIP_SCALAR) {
+                    p++;
+                }
+                break;
+            }
+
+            case JC_ST_AFTER_VALUE: {
+                p = jc_skip_ws(p, end);
+                if (p == end) break;
+                jc_stream_frame* frame = &s->stack[s->depth - 1];
+                char close = frame->kind == 'o' ? '}' : ']';
+                if (*p == close) {
+                    char* message = jc_stream_close(s);
+                    if (message) return jc_stream_fail(s, chunk, p, message, error);
+                } else if (*p == ',') {
+                    s->state = frame->kind == 'o' ? JC_ST_KEY_START : JC_ST_VALUE;
+                } else {
+                    return jc_stream_fail(s, chunk, p, "Expected ,", error);
+                }
+                p++;
+                break;
+            }
+
+            case JC_ST_STRING: {
+                if (s->escape) {
+                    // Gather the escape in the token, which may span chunks:
+                    // two bytes, six for \\u, or twelve for a surrogate pair
+                    s->token[s->token_len++] = *p++;
+                    size_t n = s->token_len;
+                    uint32_t cp = 0;
+                    if (n == 2 && s->token[1] == 'u') break;
+                    if (n > 2 && n < 6) break;
+                    if (n == 6 && jc_parse_hex4(s->token + 2, s->token + 6, &cp) && cp >= 0xD800 && cp <= 0xDBFF) break;
+                    if ((n == 7 && s->token[6] != '\\') || (n == 8 && s->token[7] != 'u')) {
+                        return jc_stream_fail(s, chunk, p - 1, "Invalid unicode escape", error);
+                    }
+                    if (n > 6 && n < 12) break;
+                    char decoded[4];
+                    size_t len;
+                    char* message = NULL;
+                    if (!jc_unescape(s->token, s->token + n, decoded, &len, &message)) {
+                        return jc_stream_fail(s, chunk, p - 1, message, error);
+                    }
+                    if (s->len + len >= s->map->size) {
+                        return jc_stream_fail(s, chunk, p, "String too long", error);
+                    }
+                    memcpy(s->dst + s->len, decoded, len);
+                    s->len += len;
+                    s->escape = false;
+                    break;
+                }
+                const char* q = jc_scan_special(p, end);
+                size_t n = q - p;
+                if (s->len + n >= s->map->size) {
+                    return jc_stream_fail(s, chunk, p, "String too long", error);
+                }
+                memcpy(s->dst + s->len, p, n);
+                s->len += n;
+                p = q;
+                if (p == end) break;
+                unsigned char c = (unsigned char)*p;
+                if (c == '"') {
+                    // Multi-byte sequences may span chunks, so check them here
+                    if (!jc_utf8_valid(s->dst, s->dst + s->len)) {
+                        return jc_stream_fail(s, chunk, p, "Invalid UTF-8", error);
+                    }
+                    s->dst[s->len] = '\0';
+                    jc_stream_value_done(s);
+                } else if (c == '\\') {
+                    s->token[0] = '\\';
+                    s->token_len = 1;
+                    s->escape = true;
+                } else if (c < 0x20) {
+                    return jc_stream_fail(s, chunk, p, "Control character in string", error);
+                } else {
+                    if (s->len + 1 >= s->map->size) {
+                        return jc_stream_fail(s, chunk, p, "String too long", error);
+                    }
+                    s->dst[s->len++] = (char)c;
+                }
+                p++;
+                break;
+            }
+
+            case JC_ST_NUMBER:
+            case JC_ST_LITERAL: {
+                bool number = s->state == JC_ST_NUMBER;
+                while (p < end && (number ? jc_is_number_char(*p) : (*p >= 'a' && *p <= 'z'))) {
+                    if (s->token_len >= JC_STREAM_TOKEN_MAX) {
+                        return jc_stream_fail(s, chunk, p, number ? "Number too long" : jc_type_error('b'), error);
+                    }
+                    s->token[s->token_len++] = *p++;
+                }
+                if (p == end) break;
+                char* message = jc_stream_finish_token(s);
+                if (message) return jc_stream_fail(s, chunk, p, message, error);
+                break;
+            }
+
+            case JC_ST_SKIP_SCALAR:
+                while (p < end && *p != ',' && *p != '}' && *p != ']' && !jc_is_ws(*p)) p++;
+                if (p < end) jc_stream_value_done(s);
+                break;
+
+            case JC_ST_SKIP_STRING:
+                if (s->escape) {
+                    s->escape = false;
+                    p++;
+                    break;
+                }
+                p = jc_scan_quote(p, end);
+                if (p == end) break;
+                if (*p == '\\') {
+                    s->escape = true;
+                } else {
+                    jc_stream_value_done(s);
+                }
+                p++;
+                break;
+
+            case JC_ST_SKIP_NESTED:
+                if (s->in_string) {
+                    if (s->escape) {
+                        s->escape = false;
+                        p++;
+                        break;
+                    }
+                    p = jc_scan_quote(p, end);
+                    if (p == end) break;
+                    if (*p == '\\') {
+                        s->escape = true;
+                    } else {
+                        s->in_string = false;
+                    }
+                    p++;
+                    break;
+                }
+                while (p < end) {
+                    char c = *p++;
+                    if (c == '"') {
+                        s->in_string = true;
+                        break;
+                    }
+                    if (c == '{' || c == '[') {
+                        s->skip_depth++;
+                    } else if (c == '}' || c == ']') {
+                        if (s->skip_depth == 0) {
+                            jc_stream_value_done(s);
+                            break;
+                        }
+                        s->skip_depth--;
+                    }
+                }
+                break;
+
+            case JC_ST_DONE:
+                p = jc_skip_ws(p, end);
+                if (p < end) return jc_stream_fail(s, chunk, p, "Unexpected content after }", error);
+                break;
+        }
+    }
+
+    s->offset += len;
+    return true;
+}
+
+// Finish an incremental parse and release the stream. Returns false if
+// any feed failed or the input ended before the top-level object closed.
+bool jc_stream_finish(jc_stream* stream, char** error) {
+    JC_FREE(stream->found_bits);
+    stream->found_bits = NULL;
+    if (stream->error) {
+        *error = stream->error;
+        return false;
+    }
+    if (stream->state != JC_ST_DONE) {
+        bool in_string = stream->state == JC_ST_STRING || stream->state == JC_ST_KEY ||
+                         stream->state == JC_ST_SKIP_STRING;
+        *error = in_string ? "Unterminated string" : "Unexpected end of input";
+        stream->error = *error;
+        stream->error_offset = stream->offset;
+        return false;
+    }
+    return true;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define JC_HAVE_MMAP 1
+#endif
+
+// A read-only view of a whole file, from jc_file_map()
+typedef struct jc_file {
+    const char* data;           // File contents (not NUL-terminated)
+    size_t len;                 // File size in bytes
+    bool mapped;                // data is a memory mapping rather than a heap copy
+} jc_file;
+
+// Map a file privately; a writable mapping copies only the pages written to
+static bool jc_file_map_mode(const char* path, jc_file* file, bool writable, char** error) {
+    file->data = "";
+    file->len = 0;
+    file->mapped = false;
+#if defined(JC_HAVE_MMAP)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        *error = "Cannot open file";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        *error = "Cannot read file";
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* data = mmap(NULL, (size_t)st.st_size, prot, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        *error = "Cannot map file";
+        return false;
+    }
+#if defined(POSIX_MADV_SEQUENTIAL)
+    posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    posix_madvise(data, (size_t)st.st_size, POSIX_MADV_WILLNEED);
+#endif
+    file->data = data;
+    file->len = (size_t)st.st_size;
+    file->mapped = true;
+    return true;
+#else
+    (void)writable;             // Heap copies are always writable
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        *error = "Cannot open file";
+        return false;
+    }
+    char* data = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+    for (;;) {
+        if (len == cap) {
+            cap = cap ? cap * 2 : 65536;
+            char* grown = JC_REALLOC(data, cap);
+            if (!grown) {
+                JC_FREE(data);
+                fclose(fp);
+                *error = "Out of memory";
+                return false;
+            }
+            data = grown;
+        }
+        size_t n = fread(data + len, 1, cap - len, fp);
+        len += n;
+        if (n == 0) break;
+    }
+    bool failed = ferror(fp);
+    fclose(fp);
+    if (failed) {
+        JC_FREE(data);
+        *error = "Cannot read file";
+        return false;
+    }
+    if (len == 0) {
+        JC_FREE(data);
+        return true;
+    }
+    file->data = data;
+    file->len = len;
+    return true;
+#endif
+}
+
+// Map a file into memory for in-place parsing, hinting the kernel that it
+// will be read sequentially. Where mmap is unavailable the file is read
+// into a heap buffer instead. Release with jc_file_unmap().
+bool jc_file_map(const char* path, jc_file* file, char** error) {
+    return jc_file_map_mode(path, file, false, error);
+}
+
+// Release a file from jc_file_map()
+void jc_file_unmap(jc_file* file) {
+    if (file->len > 0) {
+#if defined(JC_HAVE_MMAP)
+        munmap((void*)file->data, file->len);
+#else
+        JC_FREE((void*)file->data);
+#endif
+    }
+    file->data = "";
+    file->len = 0;
+    file->mapped = false;
+}
+
+// Parse a JSON file in place, without copying it, into the struct at base
+bool jc_parse_file(const char* path, const jc_schema* schema, void* base, char** error) {
+    jc_file file;
+    if (!jc_file_map(path, &file, error)) return false;
+    bool ok = parse_json_into_n(schema, base, file.data, file.len, error);
+    jc_file_unmap(&file);
+    return ok;
+}
+
+// Growable output for jc_serialize_buffer(). Zero-initialize it; set len
+// to 0 to reuse the memory for the next document, and release it with
+// jc_buffer_free().
+typedef struct jc_buffer {
+    char* data;                 // NUL-terminated JSON text
+    size_t len;                 // Bytes of JSON, excluding the NUL
+    size_t cap;                 // Allocated bytes
+} jc_buffer;
+
+// Release the memory held by a jc_buffer
+void jc_buffer_free(jc_buffer* buf) {
+    JC_FREE(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+}
+
+// Serializer output state
+typedef struct jc_writer {
+    char* buf;                  // Output bytes
+    size_t cap;                 // Usable bytes in buf, excluding the NUL
+    size_t len;                 // Bytes produced; past cap when truncated
+    jc_buffer* grow;            // Buffer to grow instead of truncating
+    bool failed;                // Growing the buffer ran out of memory
+} jc_writer;
+
+// Enlarge a growable writer so n more bytes fit
+static bool jc_writer_grow(jc_writer* w, size_t n) {
+    if (!w->grow || w->failed) return false;
+    size_t cap = w->grow->cap ? w->grow->cap * 2 : 256;
+    if (cap < w->len + n + 1) cap = w->len + n + 1;
+    char* data = JC_REALLOC(w->grow->data, cap);
+    if (!data) {
+        w->failed = true;
+        return false;
+    }
+    w->grow->data = data;
+    w->grow->cap = cap;
+    w->buf = data;
+    w->cap = cap - 1;
+    return true;
+}
+
+// Append n bytes, growing or truncating when they do not fit
+static void jc_write_slow(jc_writer* w, const char* s, size_t n) {
+    if (jc_writer_grow(w, n)) {
+        memcpy(w->buf + w->len, s, n);
+    } else if (w->len < w->cap) {
+        memcpy(w->buf + w->len, s, w->cap - w->len);
+    }
+    w->len += n;
+}
+
+static inline void jc_write(jc_writer* w, const char* s, size_t n) {
+    if (w->len + n <= w->cap) {
+        memcpy(w->buf + w->len, s, n);
+        w->len += n;
+    } else {
+        jc_write_slow(w, s, n);
+    }
+}
+
+static inline void jc_write_char(jc_writer* w, char c) {
+    if (w->len < w->cap) {
+        w->buf[w->len++] = c;
+    } else {
+        jc_write_slow(w, &c, 1);
+    }
+}
+
+static const char jc_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Format v in decimal, two digits at a time, so that it ends just before
+// end; returns the first digit
+static char* jc_format_u64(uint64_t v, char* end) {
+    char* p = end;
+    while (v >= 100) {
+        unsigned pair = (unsigned)(v % 100);
+        v /= 100;
+        p -= 2;
+        memcpy(p, jc_digit_pairs + pair * 2, 2);
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, jc_digit_pairs + v * 2, 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return p;
+}
+
+// Write an integer given as sign and magnitude
+static void jc_write_integer(jc_writer* w, bool negative, uint64_t magnitude) {
+    char tmp[24];
+    char* end = tmp + sizeof(tmp);
+    char* p = jc_format_u64(magnitude, end);
+    if (negative) *--p = '-';
+    jc_write(w, p, (size_t)(end - p));
+}
+
+// Normalized powers of ten 10^-348, 10^-340, ..., 10^340 for Grisu2:
+// 64-bit significands and their binary exponents
+static const uint64_t jc_cached_powers_f[87] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t jc_cached_powers_e[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+// Unnormalized binary floating-point value f * 2^e used by Grisu2
+typedef struct jc_diyfp {
+    uint64_t f;
+    int e;
+} jc_diyfp;
+
+// Product of two values, rounded to 64 bits
+static inline jc_diyfp jc_diyfp_mul(jc_diyfp a, jc_diyfp b) {
+    jc_u128 p = jc_mul64(a.f, b.f);
+    jc_diyfp r = {p.high + (p.low >> 63), a.e + b.e + 64};
+    return r;
+}
+
+static inline jc_diyfp jc_diyfp_normalize(jc_diyfp v) {
+    int shift = jc_clz64(v.f);
+    jc_diyfp r = {v.f << shift, v.e - shift};
+    return r;
+}
+
+static const uint64_t jc_pow10_u64[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// Move the last digit towards the exact value while it stays in range
+static void jc_grisu_round(char* digits, int len, uint64_t delta, uint64_t rest,
+                           uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        digits[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+// Generate the shortest digits of a value in (Mp - delta, Mp]
+static int jc_grisu_digits(jc_diyfp w, jc_diyfp mp, uint64_t delta, char* digits, int* k) {
+    int shift = -mp.e;
+    uint64_t one = 1ULL << shift;
+    uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> shift);
+    uint64_t p2 = mp.f & (one - 1);
+    int kappa = 1;
+    while (kappa < 10 && p1 >= jc_pow10_u64[kappa]) kappa++;
+    int len = 0;
+
+    while (kappa > 0) {
+        uint32_t d = p1 / (uint32_t)jc_pow10_u64[kappa - 1];
+        p1 %= (uint32_t)jc_pow10_u64[kappa - 1];
+        if (d || len) digits[len++] = (char)('0' + d);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << shift) + p2;
+        if (rest <= delta) {
+            *k += kappa;
+            jc_grisu_round(digits, len, delta, rest, jc_pow10_u64[kappa] << shift, wp_w);
+            return len;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> shift);
+        if (d || len) digits[len++] = (char)('0' + d);
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            jc_grisu_round(digits, len, delta, p2, one, wp_w * (-kappa < 20 ? jc_pow10_u64[-kappa] : 0));
+            return len;
+        }
+    }
+}
+
+// Grisu2: shortest digits (mostly) that read back as the same binary value.
+// bits holds a positive, finite, nonzero value of the given format. Returns
+// the digit count and stores the decimal exponent in *k.
+static int jc_grisu2(uint64_t bits, const jc_float_format* fmt, char* digits, int* k) {
+    int mbits = fmt->mantissa_bits;
+    uint64_t hidden = 1ULL << mbits;
+    uint64_t mantissa = bits & (hidden - 1);
+    int biased = (int)(bits >> mbits);
+    jc_diyfp v;
+    if (biased) {
+        v.f = mantissa | hidden;
+        v.e = biased + fmt->minimum_exponent - mbits;
+    } else {
+        v.f = mantissa;
+        v.e = 1 + fmt->minimum_exponent - mbits;
+    }
+
+    // Boundaries halfway to the neighbouring values; the lower one is
+    // closer at a power of two
+    jc_diyfp plus = {(v.f << 1) + 1, v.e - 1};
+    plus = jc_diyfp_normalize(plus);
+    jc_diyfp minus;
+    if (v.f == hidden && biased > 1) {
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    } else {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    // Scale by a cached power of ten into the range Grisu works in
+    double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0) ik++;
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    jc_diyfp c = {jc_cached_powers_f[index], jc_cached_powers_e[index]};
+
+    jc_diyfp w = jc_diyfp_mul(jc_diyfp_normalize(v), c);
+    jc_diyfp wp = jc_diyfp_mul(plus, c);
+    jc_diyfp wm = jc_diyfp_mul(minus, c);
+    wm.f++;
+    wp.f--;
+    return jc_grisu_digits(w, wp, wp.f - wm.f, digits, k);
+}
+
+// Write a decimal exponent after the 'e'
+static char* jc_format_exponent(int k, char* p) {
+    if (k < 0) {
+        *p++ = '-';
+        k = -k;
+    }
+    if (k >= 100) {
+        *p++ = (char)('0' + k / 100);
+        k %= 100;
+        memcpy(p, jc_digit_pairs + k * 2, 2);
+        p += 2;
+    } else if (k >= 10) {
+        memcpy(p, jc_digit_pairs + k * 2, 2);
+        p += 2;
+    } else {
+        *p++ = (char)('0' + k);
+    }
+    return p;
+}
+
+// Lay out digits * 10^k as a JSON number: plain notation for moderate
+// exponents, scientific otherwise. buf must hold at least 32 bytes and
+// start with the digits; returns the end of the number.
+static char* jc_format_decimal(char* buf, int len, int k) {
+    int kk = len + k;   // 10^(kk-1) <= value < 10^kk
+    if (k >= 0 && kk <= 21) {
+        // 1234e7 -> 12340000000.0
+        for (int i = len; i < kk; i++) buf[i] = '0';
+        buf[kk] = '.';
+        buf[kk + 1] = '0';
+        return buf + kk + 2;
     }
-    return false;
+    if (kk > 0 && kk <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(buf + kk + 1, buf + kk, (size_t)(len - kk));
+        buf[kk] = '.';
+        return buf + len + 1;
+    }
+    if (kk > -6 && kk <= 0) {
+        // 1234e-6 -> 0.001234
+        int offset = 2 - kk;
+        memmove(buf + offset, buf, (size_t)len);
+        buf[0] = '0';
+        buf[1] = '.';
+        for (int i = 2; i < offset; i++) buf[i] = '0';
+        return buf + len + offset;
+    }
+    if (len == 1) {
+        // 1e30
+        buf[1] = 'e';
+        return jc_format_exponent(kk - 1, buf + 2);
+    }
+    // 1234e30 -> 1.234e33
+    memmove(buf + 2, buf + 1, (size_t)(len - 1));
+    buf[1] = '.';
+    buf[len + 1] = 'e';
+    return jc_format_exponent(kk - 1, buf + len + 2);
 }
 
-// Check if we've reached the end of input
-static bool is_end(const char* ptr) {
-    while (*ptr && (*ptr == ' ' || *ptr == '\n' || *ptr == '\t' || *ptr == '\r')) ptr++;
-    return *ptr == '\0';
+// Write a binary float, given as sign and the remaining bits, in the
+// shortest form that parses back to the same value. JSON has no NaN or
+// infinity; they are written as null.
+static void jc_write_float_bits(jc_writer* w, bool negative, uint64_t magnitude,
+                                const jc_float_format* fmt) {
+    if ((magnitude >> fmt->mantissa_bits) == (uint64_t)fmt->infinite_power) {
+        jc_write(w, "null", 4);
+        return;
+    }
+
+    char tmp[40];
+    char* p = tmp;
+    if (negative) *p++ = '-';
+    if (magnitude == 0) {
+        memcpy(p, "0.0", 3);
+        p += 3;
+    } else {
+        int k;
+        int len = jc_grisu2(magnitude, fmt, p, &k);
+        p = jc_format_decimal(p, len, k);
+    }
+    jc_write(w, tmp, (size_t)(p - tmp));
 }
 
-// Parse a single value based on type
-static bool parse_value(const char** ptr, JsonMap* map, char** error, bool* found) {
-    while (**ptr && (**ptr == ' ' || **ptr == '\n' || **ptr == '\t' || **ptr == '\r')) (*ptr)++;
-    
+static void jc_write_double(jc_writer* w, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    jc_write_float_bits(w, bits >> 63, bits & ~(1ULL << 63), &jc_binary64);
+}
+
+static void jc_write_float(jc_writer* w, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    jc_write_float_bits(w, bits >> 31, bits & ~(1u << 31), &jc_binary32);
+}
+
+static inline bool jc_needs_escape(char c) {
+    return (unsigned char)c < 0x20 || c == '"' || c == '\\';
+}
+
+#if defined(JC_SIMD_SSE2)
+// Offset of the first byte a JSON string must escape in a 16-byte block, or 16
+static inline unsigned jc_sse2_escape(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i ctrl = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+    __m128i hit = _mm_or_si128(ctrl, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+    return mask ? jc_ctz(mask) : 16;
+}
+#endif
+
+// Return the first byte in [p, end) that a JSON string must escape, or end
+static inline const char* jc_scan_escape(const char* p, const char* end) {
+#if defined(JC_SIMD_SSE2)
+    while (end - p >= 16) {
+        unsigned off = jc_sse2_escape(p);
+        if (off < 16) return p + off;
+        p += 16;
+    }
+#elif defined(JC_SIMD_NEON)
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t hit = vorrq_u8(vcleq_u8(v, vdupq_n_u8(0x1F)),
+                                  vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))));
+        uint64_t mask = jc_neon_mask(hit);
+        if (mask) return p + jc_neon_first(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && !jc_needs_escape(*p)) p++;
+    return p;
+}
+
+// Write s[0, n) as a quoted JSON string, copying runs that need no
+// escaping in bulk
+static void jc_write_string(jc_writer* w, const char* s, size_t n) {
+    const char* end = s + n;
+    jc_write_char(w, '"');
+    for (;;) {
+        const char* run = jc_scan_escape(s, end);
+        if (run > s) jc_write(w, s, (size_t)(run - s));
+        if (run >= end) break;
+
+        char esc[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t esc_len = 2;
+        switch (*run) {
+            case '"': esc[1] = '"'; break;
+            case '\\': esc[1] = '\\'; break;
+            case '\b': esc[1] = 'b'; break;
+            case '\f': esc[1] = 'f'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            default:
+                memcpy(esc + 1, "u00", 3);
+                esc[4] = "0123456789abcdef"[(unsigned char)*run >> 4];
+                esc[5] = "0123456789abcdef"[(unsigned char)*run & 0xF];
+                esc_len = 6;
+                break;
+        }
+        jc_write(w, esc, esc_len);
+        s = run + 1;
+    }
+    jc_write_char(w, '"');
+}
+
+static void jc_serialize_object(jc_writer* w, const JsonMap* maps, size_t count,
+                                const jc_schema* schema, const char* base);
+
+// Write the value of one mapping stored at src
+static void jc_serialize_value(jc_writer* w, const JsonMap* map, const void* src,
+                               const jc_schema* nested_schema) {
     switch (map->type) {
         case 'i': {
-            char* endptr;
-            long val = strtol(*ptr, &endptr, 10);
-            if (*ptr == endptr) {
-                *error = "Invalid integer value";
-                return false;
-            }
-            *(int*)map->struct_member = (int)val;
-            *ptr = endptr;
-            *found = true;
-            return true;
+            int v = *(const int*)src;
+            jc_write_integer(w, v < 0, v < 0 ? 0 - (uint64_t)(int64_t)v : (uint64_t)v);
+            break;
+        }
+        case 'I': {
+            int64_t v = *(const int64_t*)src;
+            jc_write_integer(w, v < 0, v < 0 ? 0 - (uint64_t)v : (uint64_t)v);
+            break;
         }
+        case 'U':
+            jc_write_integer(w, false, *(const uint64_t*)src);
+            break;
         case 's': {
-            if (**ptr != '"') {
-                *error = "Expected string value";
-                return false;
-            }
-            (*ptr)++;
-            char* str_start = (char*)*ptr;
-            while (**ptr && **ptr != '"') (*ptr)++;
-            if (**ptr != '"') {
-                *error = "Unterminated string";
-                return false;
-            }
-            size_t len = *ptr - str_start;
-            if (len >= map->size) {
-                *error = "String too long";
-                return false;
+            const char* nul = memchr(src, '\0', map->size);
+            jc_write_string(w, src, nul ? (size_t)(nul - (const char*)src) : map->size);
+            break;
+        }
+        case 'S': {
+            // Escaped views hold JSON text already and are copied verbatim
+            const jc_str* str = src;
+            if (str->escaped) {
+                jc_write_char(w, '"');
+                if (str->len) jc_write(w, str->ptr, str->len);
+                jc_write_char(w, '"');
+            } else {
+                jc_write_string(w, str->ptr, str->len);
             }
-            strncpy(map->struct_member, str_start, len);
-            ((char*)map->struct_member)[len] = '\0';
-            (*ptr)++;
-            *found = true;
-            return true;
+            break;
         }
-        case 'b': {
-            if (strncmp(*ptr, "true", 4) == 0) {
-                *(bool*)map->struct_member = true;
-                *ptr += 4;
-                *found = true;
-                return true;
-            } else if (strncmp(*ptr, "false", 5) == 0) {
-                *(bool*)map->struct_member = false;
-                *ptr += 5;
-                *found = true;
-                return true;
+        case 'e': {
+            int v = *(const int*)src;
+            if (v >= 0 && (size_t)v < map->size) {
+                const char* name = map->nested[v].json_key;
+                jc_write_string(w, name, strlen(name));
+            } else {
+                jc_write(w, "null", 4);
             }
-            *error = "Invalid boolean value";
-            return false;
+            break;
         }
-        case 'd': {
-            char* endptr;
-            double val = strtod(*ptr, &endptr);
-            if (*ptr == endptr) {
-                *error = "Invalid double value";
-                return false;
+        case 'n': {
+            const char* str = *(const char* const*)src;
+            if (str) {
+                jc_write_string(w, str, strlen(str));
+            } else {
+                jc_write(w, "null", 4);
             }
-            *(double*)map->struct_member = val;
-            *ptr = endptr;
-            *found = true;
-            return true;
+            break;
         }
-        case 'o': {
-            if (**ptr != '{') {
-                *error = "Expected object";
-                return false;
+        case 'b':
+            if (*(const bool*)src) {
+                jc_write(w, "true", 4);
+            } else {
+                jc_write(w, "false", 5);
             }
-            (*ptr)++;
-            
-            bool* nested_found = calloc(map->size, sizeof(bool));
-            
-            while (**ptr) {
-                if (skip_char(ptr, '}')) break;
-                
-                if (**ptr != '"') {
-                    *error = "Expected property name";
-                    free(nested_found);
-                    return false;
-                }
-                (*ptr)++;
-                
-                char* key_start = (char*)*ptr;
-                while (**ptr && **ptr != '"') (*ptr)++;
-                size_t key_len = *ptr - key_start;
-                (*ptr)++;
-                
-                if (!skip_char(ptr, ':')) {
-                    *error = "Expected ':'";
-                    free(nested_found);
-                    return false;
-                }
-                
-                // Find matching nested mapping
-                JsonMap* nested_map = NULL;
-                int nested_index = -1;
-                for (size_t i = 0; i < map->size; i++) {
-                    if (strncmp(map->nested[i].json_key, key_start, key_len) == 0 && 
-                        strlen(map->nested[i].json_key) == key_len) {
-                        nested_map = &map->nested[i];
-                        nested_index = i;
-                        break;
-                    }
-                }
-                
-                if (nested_map) {
-                    bool nested_field_found = false;
-                    if (!parse_value(ptr, nested_map, error, &nested_field_found)) {
-                        free(nested_found);
-                        return false;
-                    }
-                    if (nested_field_found) {
-                        nested_found[nested_index] = true;
-                    }
-                } else {
-                    // Skip unknown property
-                    int depth = 1;
-                    while (**ptr && depth > 0) {
-                        if (**ptr == '{' || **ptr == '[') depth++;
-                        if (**ptr == '}' || **ptr == ']') depth--;
-                        (*ptr)++;
-                    }
-                }
-                
-                skip_char(ptr, ',');
+            break;
+        case 'd':
+            jc_write_double(w, *(const double*)src);
+            break;
+        case 'f':
+            jc_write_float(w, *(const float*)src);
+            break;
+        case 'o':
+            if (nested_schema) {
+                jc_serialize_object(w, nested_schema->maps, nested_schema->count, nested_schema, src);
+            } else {
+                jc_serialize_object(w, map->nested, map->size, NULL, src);
             }
-            
-            // Check required fields in nested object
+            break;
+        case 'a': {
+            const JsonMap* item_map = map->nested;
+            size_t item_size = jc_item_size(item_map);
+            jc_write_char(w, '[');
             for (size_t i = 0; i < map->size; i++) {
-                if (map->nested[i].required && !nested_found[i]) {
-                    *error = "Missing required field in nested object";
-                    free(nested_found);
-                    return false;
-                }
+                if (i) jc_write_char(w, ',');
+                jc_serialize_value(w, item_map, (const char*)src + i * item_size, nested_schema);
             }
-            
-            free(nested_found);
-            *found = true;
-            return true;
+            jc_write_char(w, ']');
+            break;
         }
-        case 'a': {
-            if (**ptr != '[') {
-                *error = "Expected array";
-                return false;
+        case 'v': {
+            const JsonMap* item_map = map->nested;
+            size_t item_size = jc_item_size(item_map);
+            const jc_array* array = src;
+            jc_write_char(w, '[');
+            for (size_t i = 0; i < array->count; i++) {
+                if (i) jc_write_char(w, ',');
+                jc_serialize_value(w, item_map, (const char*)array->items + i * item_size, nested_schema);
             }
-            (*ptr)++;
-            
-            // Get array pointer and sizes
-            void* array = map->struct_member;
-            size_t array_len = map->size;  // Number of elements in array
-            JsonMap* item_map = map->nested;
-            size_t item_size = (item_map->type == 's') ? item_map->size : sizeof(int);  // Size of each element
-            size_t count = 0;
-            
-            while (**ptr) {
-                if (skip_char(ptr, ']')) break;
-                
-                if (count >= array_len) {
-                    *error = "Array too long";
-                    return false;
-                }
-                
-                // Calculate pointer to current array element
-                void* item_ptr;
-                if (item_map->type == 's') {
-                    // For string arrays, calculate offset using item_size
-                    item_ptr = (char*)array + (count * item_size);
-                } else {
-                    // For integer arrays, use sizeof(int)
-                    item_ptr = (int*)array + count;
-                }
-                
-                JsonMap current_item = *item_map;
-                current_item.struct_member = item_ptr;
-                
-                bool item_found = false;
-                if (!parse_value(ptr, &current_item, error, &item_found)) {
-                    return false;
+            jc_write_char(w, ']');
+            break;
+        }
+        case 'c': {
+            // One object per row, gathered from the columns
+            const jc_schema* row_schema = nested_schema;
+            size_t rows = *(const size_t*)src;
+            jc_write_char(w, '[');
+            for (size_t r = 0; r < rows; r++) {
+                if (r) jc_write_char(w, ',');
+                jc_write_char(w, '{');
+                for (size_t i = 0; i < row_schema->count; i++) {
+                    const JsonMap* field = &row_schema->maps[i];
+                    const char* cell = (const char*)src + (uintptr_t)field->struct_member +
+                                       r * jc_type_size(field);
+                    if (i) jc_write_char(w, ',');
+                    jc_write_string(w, field->json_key, row_schema->key_lens[i]);
+                    jc_write_char(w, ':');
+                    jc_serialize_value(w, field, cell, NULL);
                 }
-                
-                count++;
-                skip_char(ptr, ',');
-            }
-            
-            if (count < array_len) {
-                *error = "Array too short";
-                return false;
+                jc_write_char(w, '}');
             }
-            
-            *found = true;
-            return true;
+            jc_write_char(w, ']');
+            break;
         }
         default:
-            *error = "Unknown type";
-            return false;
+            jc_write(w, "null", 4);
+            break;
     }
 }
 
-// Main parsing function
-bool parse_json(const char* json, JsonMap* mappings, int map_count, char** error) {
-    if (!json) {
-        *error = "NULL input";
-        return false;
+// Write an object for the given mappings. For offset-based schemas, member
+// offsets are resolved against base.
+static void jc_serialize_object(jc_writer* w, const JsonMap* maps, size_t count,
+                                const jc_schema* schema, const char* base) {
+    bool relative = schema && schema->relative;
+    jc_write_char(w, '{');
+    for (size_t i = 0; i < count; i++) {
+        const JsonMap* map = &maps[i];
+        const void* src = relative ? base + (uintptr_t)map->struct_member : map->struct_member;
+        if (i) jc_write_char(w, ',');
+        jc_write_string(w, map->json_key, schema ? schema->key_lens[i] : strlen(map->json_key));
+        jc_write_char(w, ':');
+        jc_serialize_value(w, map, src, schema ? schema->nested[i] : NULL);
+    }
+    jc_write_char(w, '}');
+}
+
+// Write the struct at base (ignored for absolute schemas) as compact JSON
+// into out_buf. Like snprintf(), at most cap bytes are stored, the output
+// is NUL-terminated whenever cap > 0, and the return value is the full
+// length of the JSON: a result >= cap means out_buf was too small.
+size_t jc_serialize(const jc_schema* schema, const void* base, char* out_buf, size_t cap) {
+    if (!schema || (schema->relative && !base)) {
+        if (cap > 0) out_buf[0] = '\0';
+        return 0;
     }
 
-    const char* ptr = json;
-    bool* found = calloc(map_count, sizeof(bool));
-    
-    // Skip initial whitespace and {
-    if (!skip_char(&ptr, '{')) {
-        *error = "Expected {";
-        free(found);
+    jc_writer w = {out_buf, cap ? cap - 1 : 0, 0, NULL, false};
+    jc_serialize_object(&w, schema->maps, schema->count, schema, base);
+    if (cap > 0) out_buf[w.len < w.cap ? w.len : w.cap] = '\0';
+    return w.len;
+}
+
+// Append the struct at base as compact JSON to buf, growing it as needed.
+// Returns false, leaving buf's contents unchanged, if memory runs out.
+bool jc_serialize_buffer(const jc_schema* schema, const void* base, jc_buffer* buf) {
+    if (!schema || (schema->relative && !base)) return false;
+
+    jc_writer w = {buf->data, buf->cap ? buf->cap - 1 : 0, buf->len, buf, false};
+    if (!buf->data && !jc_writer_grow(&w, 0)) return false;
+    jc_serialize_object(&w, schema->maps, schema->count, schema, base);
+    if (w.failed) {
+        if (buf->data) buf->data[buf->len] = '\0';
         return false;
     }
+    buf->len = w.len;
+    buf->data[buf->len] = '\0';
+    return true;
+}
 
-    bool first_field = true;
-    bool found_end = false;
-    while (*ptr) {
-        // Handle end of object
-        if (skip_char(&ptr, '}')) {
-            // Check for trailing content
-            if (!is_end(ptr)) {
-                *error = "Unexpected content after }";
-                free(found);
-                return false;
-            }
-            found_end = true;
-            break;
-        }
+#define JC_IMAGE_VERSION 1          // Layout of images from jc_image_write()
+#define JC_IMAGE_HEADER 64          // Bytes before the struct in an image
+#define JC_IMAGE_BYTE_ORDER 0x01020304u
 
-        // Check for premature end of input
-        if (!*ptr) {
-            *error = "Unexpected end of input";
-            free(found);
-            return false;
-        }
+// Start of a binary image: a parsed struct followed by the strings and
+// array items it points to, with pointers stored as image offsets
+typedef struct jc_image_header {
+    char magic[8];              // "JCIMAGE"
+    uint32_t version;           // JC_IMAGE_VERSION
+    uint32_t byte_order;        // JC_IMAGE_BYTE_ORDER as the writer stored it
+    uint64_t fingerprint;       // jc_schema_fingerprint() of the writer's schema
+    uint64_t size;              // Struct size
+    uint64_t total;             // Image size, header included
+} jc_image_header;
 
-        // Handle comma between fields
-        if (!first_field) {
-            if (!skip_char(&ptr, ',')) {
-                *error = "Expected ,";
-                free(found);
-                return false;
-            }
-        }
+// A loaded image, from jc_image_load()
+typedef struct jc_image {
+    void* data;                 // The struct, inside the mapping
+    size_t size;                // Struct size
+    jc_file file;               // Mapping of the whole image
+} jc_image;
 
-        // Check for trailing comma
-        if (skip_char(&ptr, '}')) {
-            *error = "Trailing comma";
-            free(found);
+// Fold bytes into a 64-bit FNV-1a hash
+static uint64_t jc_fnv64(uint64_t h, const void* data, size_t len) {
+    const unsigned char* p = data;
+    for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+// Hash everything about a mapping that shapes the struct it fills
+static uint64_t jc_map_fingerprint(uint64_t h, const JsonMap* map) {
+    const char* key = map->json_key ? map->json_key : "";
+    uint64_t fields[4] = {(uint64_t)(unsigned char)map->type, map->required, map->size,
+                          (uint64_t)(uintptr_t)map->struct_member};
+    h = jc_fnv64(h, key, strlen(key) + 1);
+    h = jc_fnv64(h, fields, sizeof(fields));
+    if ((map->type == 'o' || map->type == 'e') && map->nested) {
+        for (size_t i = 0; i < map->size; i++) h = jc_map_fingerprint(h, &map->nested[i]);
+    } else if ((map->type == 'a' || map->type == 'v' || map->type == 'c') && map->nested) {
+        h = jc_map_fingerprint(h, map->nested);
+    }
+    return h;
+}
+
+// Identify the struct layout an offset-based schema fills: keys, types,
+// sizes, offsets and nesting, plus the struct size, pointer width and
+// image version. Images only load into a schema with the same fingerprint.
+uint64_t jc_schema_fingerprint(const jc_schema* schema, size_t size) {
+    uint64_t platform[4] = {JC_IMAGE_VERSION, size, sizeof(void*), sizeof(size_t)};
+    uint64_t h = jc_fnv64(0xcbf29ce484222325ULL, platform, sizeof(platform));
+    for (size_t i = 0; i < schema->count; i++) h = jc_map_fingerprint(h, &schema->maps[i]);
+    return h;
+}
+
+// Whether values of a mapping hold pointers ('S' views, 'v' arrays or 'n' strings)
+static bool jc_map_has_pointers(const JsonMap* map) {
+    switch (map->type) {
+        case 'S':
+        case 'v':
+        case 'n':
+            return true;
+        case 'o':
+            for (size_t i = 0; map->nested && i < map->size; i++) {
+                if (jc_map_has_pointers(&map->nested[i])) return true;
+            }
             return false;
-        }
+        case 'a':
+        case 'c':
+            return map->nested && jc_map_has_pointers(map->nested);
+        default:
+            return false;
+    }
+}
+
+static bool jc_schema_has_pointers(const jc_schema* schema) {
+    for (size_t i = 0; i < schema->count; i++) {
+        if (jc_map_has_pointers(&schema->maps[i])) return true;
+    }
+    return false;
+}
+
+// Append len bytes at the next multiple of align, zero-filling the gap
+static bool jc_image_append(jc_buffer* out, const void* data, size_t len, size_t align, size_t* at) {
+    size_t start = (out->len + align - 1) & ~(align - 1);
+    if (start + len > out->cap) {
+        size_t cap = out->cap ? out->cap * 2 : 4096;
+        if (cap < start + len) cap = start + len;
+        char* grown = JC_REALLOC(out->data, cap);
+        if (!grown) return false;
+        out->data = grown;
+        out->cap = cap;
+    }
+    memset(out->data + out->len, 0, start - out->len);
+    if (len) memcpy(out->data + start, data, len);
+    out->len = start + len;
+    *at = start;
+    return true;
+}
+
+// Pointer rewriting over a struct inside an image: writing copies each
+// pointer's target into the image and stores its offset; loading turns
+// the offsets back into addresses within the mapping
+typedef struct jc_image_walk {
+    jc_buffer* out;             // Image being written, or NULL when loading
+    char* data;                 // Image being loaded
+    size_t len;                 // Its size
+    char** error;
+} jc_image_walk;
 
-        if (*ptr != '"') {
-            *error = "Expected property name";
-            free(found);
+static inline char* jc_image_at(const jc_image_walk* w, size_t at) {
+    return (w->out ? w->out->data : w->data) + at;
+}
+
+// Rewrite the pointer at image offset at, to a block of bytes, and store
+// the block's offset in *offset (0 for NULL)
+static bool jc_image_link(jc_image_walk* w, size_t at, size_t bytes, size_t align, size_t* offset) {
+    if (w->out) {
+        const void* target;
+        memcpy(&target, jc_image_at(w, at), sizeof(target));
+        *offset = 0;
+        if (target && !jc_image_append(w->out, target, bytes, align, offset)) {
+            *w->error = "Out of memory";
             return false;
         }
-        ptr++;
-        
-        // Get key
-        char* key_start = (char*)ptr;
-        while (*ptr && *ptr != '"') ptr++;
-        if (!*ptr) {
-            *error = "Unterminated string";
-            free(found);
+        uintptr_t stored = *offset;
+        memcpy(jc_image_at(w, at), &stored, sizeof(stored));
+        return true;
+    }
+    uintptr_t stored;
+    memcpy(&stored, jc_image_at(w, at), sizeof(stored));
+    void* target = NULL;
+    if (stored || bytes) {
+        if (stored < JC_IMAGE_HEADER || stored > w->len || bytes > w->len - stored) {
+            *w->error = "Corrupt image";
             return false;
         }
-        size_t key_len = ptr - key_start;
-        ptr++;
-        
-        if (!skip_char(&ptr, ':')) {
-            *error = "Expected :";
-            free(found);
+        target = w->data + stored;
+    }
+    memcpy(jc_image_at(w, at), &target, sizeof(target));
+    *offset = (size_t)stored;
+    return true;
+}
+
+static bool jc_image_value(jc_image_walk* w, const JsonMap* map, const jc_schema* nested_schema,
+                           size_t at);
+
+static bool jc_image_object(jc_image_walk* w, const JsonMap* maps, size_t count,
+                            const jc_schema* schema, size_t at) {
+    for (size_t i = 0; i < count; i++) {
+        if (!jc_map_has_pointers(&maps[i])) continue;
+        if (!jc_image_value(w, &maps[i], schema ? schema->nested[i] : NULL,
+                            at + (uintptr_t)maps[i].struct_member)) {
             return false;
         }
+    }
+    return true;
+}
 
-        // Find matching mapping
-        JsonMap* map = NULL;
-        int map_index = -1;
-        for (int i = 0; i < map_count; i++) {
-            if (strncmp(mappings[i].json_key, key_start, key_len) == 0 && 
-                strlen(mappings[i].json_key) == key_len) {
-                map = &mappings[i];
-                map_index = i;
-                break;
+// Rewrite the pointers in one value at image offset at
+static bool jc_image_value(jc_image_walk* w, const JsonMap* map, const jc_schema* nested_schema,
+                           size_t at) {
+    switch (map->type) {
+        case 'S': {
+            jc_str str;
+            size_t offset;
+            memcpy(&str, jc_image_at(w, at), sizeof(str));
+            return jc_image_link(w, at + offsetof(jc_str, ptr), str.len, 1, &offset);
+        }
+        case 'n': {
+            // Loading checks that the string ends inside the image
+            const char* str;
+            size_t offset;
+            memcpy(&str, jc_image_at(w, at), sizeof(str));
+            if (!jc_image_link(w, at, w->out && str ? strlen(str) + 1 : 0, 1, &offset)) return false;
+            if (!w->out && offset && !memchr(w->data + offset, '\0', w->len - offset)) {
+                *w->error = "Corrupt image";
+                return false;
             }
+            return true;
         }
-
-        if (map) {
-            bool field_found = false;
-            if (!parse_value(&ptr, map, error, &field_found)) {
-                free(found);
+        case 'v': {
+            jc_array array;
+            memcpy(&array, jc_image_at(w, at), sizeof(array));
+            const JsonMap* item_map = map->nested;
+            size_t item_size = jc_item_size(item_map);
+            size_t items;
+            if (item_size && array.count > SIZE_MAX / item_size) {
+                *w->error = "Corrupt image";
                 return false;
             }
-            if (field_found && map_index >= 0) {
-                found[map_index] = true;
+            if (!jc_image_link(w, at + offsetof(jc_array, items), array.count * item_size,
+                               _Alignof(max_align_t), &items)) {
+                return false;
             }
-        } else {
-            // Skip unknown property
-            int depth = 1;
-            while (*ptr && depth > 0) {
-                if (*ptr == '{' || *ptr == '[') depth++;
-                if (*ptr == '}' || *ptr == ']') depth--;
-                ptr++;
+            if (!jc_map_has_pointers(item_map)) return true;
+            for (size_t i = 0; i < array.count; i++) {
+                if (!jc_image_value(w, item_map, nested_schema, items + i * item_size)) return false;
             }
+            return true;
         }
-        
-        first_field = false;
+        case 'a': {
+            const JsonMap* item_map = map->nested;
+            size_t item_size = jc_item_size(item_map);
+            for (size_t i = 0; i < map->size; i++) {
+                if (!jc_image_value(w, item_map, nested_schema, at + i * item_size)) return false;
+            }
+            return true;
+        }
+        case 'o':
+            if (nested_schema) {
+                return jc_image_object(w, nested_schema->maps, nested_schema->count, nested_schema, at);
+            }
+            return jc_image_object(w, map->nested, map->size, NULL, at);
+        case 'c': {
+            // Rewrite each pointer column, row by row
+            const JsonMap* row_map = map->nested;
+            const JsonMap* fields = nested_schema ? nested_schema->maps : row_map->nested;
+            size_t field_count = nested_schema ? nested_schema->count : row_map->size;
+            size_t rows;
+            memcpy(&rows, jc_image_at(w, at), sizeof(rows));
+            if (rows > map->size) {
+                *w->error = "Corrupt image";
+                return false;
+            }
+            for (size_t f = 0; f < field_count; f++) {
+                if (!jc_map_has_pointers(&fields[f])) continue;
+                size_t column = at + (uintptr_t)fields[f].struct_member;
+                for (size_t r = 0; r < rows; r++) {
+                    if (!jc_image_value(w, &fields[f], NULL, column + r * jc_type_size(&fields[f]))) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+        default:
+            return true;
     }
+}
 
-    // Check if we found the closing brace
-    if (!found_end) {
-        *error = "Missing closing brace";
-        free(found);
+// Write the struct of size bytes at base, filled through an offset-based
+// schema, as a position-independent image into out (replacing its
+// contents). Strings of 'S' views and 'n' fields and items of 'v' arrays
+// are copied in; each 'n' field gets its own copy, so loaded ones compare
+// with strcmp() rather than ==.
+bool jc_image_write(const jc_schema* schema, const void* base, size_t size, jc_buffer* out,
+                    char** error) {
+    if (!schema) {
+        *error = "NULL schema";
+        return false;
+    }
+    if (!schema->relative) {
+        *error = "Schema must use offsets";
+        return false;
+    }
+    if (!base) {
+        *error = "NULL destination";
         return false;
     }
 
-    // Check if all required fields were found
-    for (int i = 0; i < map_count; i++) {
-        if (mappings[i].required && !found[i]) {
-            *error = "Missing required field";
-            free(found);
-            return false;
-        }
+    jc_image_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "JCIMAGE", 8);
+    header.version = JC_IMAGE_VERSION;
+    header.byte_order = JC_IMAGE_BYTE_ORDER;
+    header.fingerprint = jc_schema_fingerprint(schema, size);
+    header.size = size;
+
+    size_t at;
+    out->len = 0;
+    if (!jc_image_append(out, &header, sizeof(header), 1, &at) ||
+        !jc_image_append(out, base, size, JC_IMAGE_HEADER, &at)) {
+        *error = "Out of memory";
+        return false;
     }
+    jc_image_walk w = {out, NULL, 0, error};
+    if (!jc_image_object(&w, schema->maps, schema->count, schema, JC_IMAGE_HEADER)) return false;
 
-    free(found);
+    header.total = out->len;
+    memcpy(out->data, &header, sizeof(header));
     return true;
 }
 
+// Map an image written for the same schema and struct size. Only the
+// header is checked, and images whose schema holds no pointers are used
+// in place without touching the rest. Otherwise their pointers are
+// rebased, which copies just the pages they sit on. A false return with
+// "Schema mismatch" or "Unsupported image version" means the image is
+// stale: parse the JSON instead. Release with jc_image_close().
+bool jc_image_load(const char* path, const jc_schema* schema, size_t size, jc_image* image,
+                   char** error) {
+    image->data = NULL;
+    image->size = 0;
+    if (!schema) {
+        *error = "NULL schema";
+        return false;
+    }
+    if (!schema->relative) {
+        *error = "Schema must use offsets";
+        return false;
+    }
+    bool relocate = jc_schema_has_pointers(schema);
+    if (!jc_file_map_mode(path, &image->file, relocate, error)) return false;
+
+    jc_image_header header;
+    const char* data = image->file.data;
+    size_t len = image->file.len;
+    if (len >= sizeof(header)) memcpy(&header, data, sizeof(header));
+    if (len < sizeof(header) || memcmp(header.magic, "JCIMAGE", 8) != 0) {
+        *error = "Not an image";
+    } else if (header.version != JC_IMAGE_VERSION) {
+        *error = "Unsupported image version";
+    } else if (header.byte_order != JC_IMAGE_BYTE_ORDER) {
+        *error = "Image byte order mismatch";
+    } else if (header.size != size || header.fingerprint != jc_schema_fingerprint(schema, size)) {
+        *error = "Schema mismatch";
+    } else if (header.total != len || len < JC_IMAGE_HEADER + size) {
+        *error = "Truncated image";
+    } else {
+        jc_image_walk w = {NULL, (char*)data, len, error};
+        if (!relocate || jc_image_object(&w, schema->maps, schema->count, schema, JC_IMAGE_HEADER)) {
+            image->data = (char*)data + JC_IMAGE_HEADER;
+            image->size = size;
+            return true;
+        }
+    }
+    jc_file_unmap(&image->file);
+    return false;
+}
+
+// Release an image from jc_image_load(); its struct becomes invalid
+void jc_image_close(jc_image* image) {
+    jc_file_unmap(&image->file);
+    image->data = NULL;
+    image->size = 0;
+}
+
+// Parse len bytes of JSON into a struct of size bytes and save it as an
+// image at path for jc_image_load(). opts supplies the arena for 'v'
+// arrays. The file is written under a temporary name and renamed into
+// place, so readers never see a partial image.
+bool jc_compile_to_binary(const jc_schema* schema, size_t size, const char* json, size_t len,
+                          const jc_options* opts, const char* path, char** error) {
+    void* base = JC_CALLOC(1, size ? size : 1);
+    size_t path_len = strlen(path);
+    char* tmp = JC_MALLOC(path_len + 5);
+    jc_buffer image = {NULL, 0, 0};
+    if (!base || !tmp) {
+        JC_FREE(base);
+        JC_FREE(tmp);
+        *error = "Out of memory";
+        return false;
+    }
+    memcpy(tmp, path, path_len);
+    memcpy(tmp + path_len, ".tmp", 5);
+
+    bool ok = parse_json_ex(schema, base, json, len, opts, error) &&
+              jc_image_write(schema, base, size, &image, error);
+    if (ok) {
+        FILE* fp = fopen(tmp, "wb");
+        ok = fp && fwrite(image.data, 1, image.len, fp) == image.len;
+        if (fp && fclose(fp) != 0) ok = false;
+        if (ok && rename(tmp, path) != 0) ok = false;
+        if (!ok) {
+            remove(tmp);
+            *error = "Cannot write file";
+        }
+    }
+    jc_buffer_free(&image);
+    JC_FREE(tmp);
+    JC_FREE(base);
+    return ok;
+}
+
 #endif
@@ -1,3 +1,35 @@
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Count the library's heap allocations; alloc_fail simulates exhaustion
+static size_t alloc_count = 0;
+static bool alloc_fail = false;
+static void* counting_malloc(size_t size) { alloc_count++; return alloc_fail ? NULL : malloc(size); }
+static void* counting_calloc(size_t n, size_t size) { alloc_count++; return calloc(n, size); }
+static void* counting_realloc(void* ptr, size_t size) { alloc_count++; return realloc(ptr, size); }
+#define JC_MALLOC(size) counting_malloc(size)
+#define JC_CALLOC(count, size) counting_calloc(count, size)
+#define JC_REALLOC(ptr, size) counting_realloc(ptr, size)
+#define JC_FREE(ptr) free(ptr)
+
+// Record what the instrumentation hooks see
+static _Atomic size_t hook_parses = 0;
+static _Atomic size_t hook_failures = 0;
+static _Atomic size_t hook_fields = 0;
+static _Atomic size_t hook_skips = 0;
+static _Atomic size_t hook_last_fields = 0;
+#define JC_HOOK_BEGIN(schema, json, len) size_t hook_fields_before = hook_fields
+#define JC_HOOK_END(schema, stats, ok) \
+    do { \
+        hook_parses++; \
+        hook_failures += !(ok); \
+        hook_last_fields = hook_fields - hook_fields_before; \
+    } while (0)
+#define JC_HOOK_FIELD(map) (hook_fields++)
+#define JC_HOOK_SKIP(key, key_len) (hook_skips++)
+
+#define JC_THREADS
+#define JC_RING_BUFFER_SIZE 4096   // Small buffers, so records straddle many of them
 #include "../jsoncraftor.h"
 #include <stdio.h>
 #include <string.h>
@@ -149,6 +181,1744 @@ void test_error_cases() {
     ASSERT(!result4, "Invalid value type detection");
 }
 
+void test_compiled_schema() {
+    printf("\nTesting compiled schema:\n");
+    TestPerson person;
+    char* error = NULL;
+
+    JsonMap address_mappings[] = {
+        {"street", &person.address.street, 's', sizeof(person.address.street), true, NULL},
+        {"number", &person.address.number, 'i', 0, true, NULL},
+        {"city", &person.address.city, 's', sizeof(person.address.city), false, NULL}
+    };
+    JsonMap score_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap mappings[] = {
+        {"age", &person.age, 'i', 0, true, NULL},
+        {"name", &person.name, 's', sizeof(person.name), true, NULL},
+        {"address", &person.address, 'o', 3, true, address_mappings},
+        {"scores", person.scores, 'a', 5, true, &score_item}
+    };
+
+    jc_schema* schema = jc_schema_compile(mappings, 4, &error);
+    ASSERT(schema != NULL, "Schema compilation");
+
+    const char* json = "{"
+        "\"scores\": [1, 2, 3, 4, 5],"
+        "\"address\": {\"city\": \"Paris\", \"number\": 7, \"street\": \"Rue\"},"
+        "\"name\": \"Ann\","
+        "\"age\": 31"
+    "}";
+    bool result = parse_json_schema(json, schema, &error);
+    ASSERT(result, "Compiled schema parsing");
+    ASSERT(person.age == 31 && strcmp(person.name, "Ann") == 0, "Compiled schema top-level fields");
+    ASSERT(person.address.number == 7 && strcmp(person.address.city, "Paris") == 0, "Compiled schema nested fields");
+    ASSERT(person.scores[4] == 5, "Compiled schema array field");
+
+    bool result2 = parse_json_schema("{\"age\": 1, \"scores\": [1, 2, 3, 4, 5]}", schema, &error);
+    ASSERT(!result2, "Compiled schema missing required field");
+    jc_schema_free(schema);
+
+    // Wide object: many keys that differ only in their last characters
+    enum { WIDE = 120 };
+    static int values[WIDE];
+    static char keys[WIDE][16];
+    static JsonMap wide[WIDE];
+    char wide_json[WIDE * 24];
+    char* out = wide_json;
+    out += sprintf(out, "{");
+    for (int i = 0; i < WIDE; i++) {
+        sprintf(keys[i], "field_%03d", i);
+        wide[i] = (JsonMap){keys[i], &values[i], 'i', 0, true, NULL};
+        out += sprintf(out, "%s\"field_%03d\": %d", i ? "," : "", WIDE - 1 - i, WIDE - 1 - i);
+    }
+    sprintf(out, "}");
+
+    schema = jc_schema_compile(wide, WIDE, &error);
+    bool result3 = schema && parse_json_schema(wide_json, schema, &error);
+    ASSERT(result3, "Wide object parsing with compiled schema");
+    ASSERT(values[0] == 0 && values[57] == 57 && values[WIDE - 1] == WIDE - 1, "Wide object values");
+    jc_schema_free(schema);
+
+    JsonMap duplicate[] = {
+        {"age", &person.age, 'i', 0, true, NULL},
+        {"age", &person.age, 'i', 0, true, NULL}
+    };
+    ASSERT(jc_schema_compile(duplicate, 2, &error) == NULL, "Duplicate key rejected by compiler");
+}
+
+void test_offset_schema() {
+    printf("\nTesting offset-based schema:\n");
+    char* error = NULL;
+
+    JsonMap address_mappings[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(((TestAddress*)0)->street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL},
+        {"city", JC_OFFSET(TestAddress, city), 's', sizeof(((TestAddress*)0)->city), false, NULL}
+    };
+    JsonMap tag_item = {"item", NULL, 's', 20, false, NULL};
+    JsonMap mappings[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"name", JC_OFFSET(TestPerson, name), 's', sizeof(((TestPerson*)0)->name), true, NULL},
+        {"address", JC_OFFSET(TestPerson, address), 'o', 3, true, address_mappings},
+        {"tags", JC_OFFSET(TestPerson, tags), 'a', 3, false, &tag_item}
+    };
+
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 4, &error);
+    ASSERT(schema != NULL, "Offset schema compilation");
+
+    TestPerson people[2];
+    const char* json1 = "{\"age\": 40, \"name\": \"Ada\", \"address\": {\"street\": \"Elm\", \"number\": 1}, "
+                        "\"tags\": [\"a\", \"b\", \"c\"]}";
+    const char* json2 = "{\"age\": 41, \"name\": \"Bob\", \"address\": {\"street\": \"Oak\", \"number\": 2}}";
+    bool result1 = parse_json_into(schema, &people[0], json1, &error);
+    bool result2 = parse_json_into(schema, &people[1], json2, &error);
+    ASSERT(result1 && result2, "Parsing into two instances with one schema");
+    ASSERT(people[0].age == 40 && strcmp(people[0].name, "Ada") == 0, "First instance top-level fields");
+    ASSERT(people[1].age == 41 && strcmp(people[1].name, "Bob") == 0, "Second instance top-level fields");
+    ASSERT(strcmp(people[0].address.street, "Elm") == 0 && people[1].address.number == 2, "Nested offsets resolved per instance");
+    ASSERT(strcmp(people[0].tags[2], "c") == 0, "Array offset resolved per instance");
+
+    bool result3 = parse_json_into(schema, NULL, json1, &error);
+    ASSERT(!result3, "NULL destination rejected");
+    jc_schema_free(schema);
+}
+
+void test_whitespace_and_long_strings() {
+    printf("\nTesting whitespace and long strings:\n");
+    TestPerson person;
+    char* error = NULL;
+
+    // Runs longer than one SIMD block, with odd lengths to exercise the tails
+    char json[1024];
+    snprintf(json, sizeof(json),
+             "{\n%*s\"name\"%*s:%*s\"%s\",\r\n%*s\"age\"\t:\t%d\n%*s}%*s",
+             37, "", 19, "", 45, "", "Abcdefghijklmnopqrstuvwxyz0123456789-abcdefghi", 70, "", 42, 3, "", 65, "");
+
+    JsonMap mappings[] = {
+        {"age", &person.age, 'i', 0, true, NULL},
+        {"name", &person.name, 's', sizeof(person.name), true, NULL}
+    };
+
+    bool result = parse_json(json, mappings, 2, &error);
+    ASSERT(result, "Pretty-printed input parsing");
+    ASSERT(strcmp(person.name, "Abcdefghijklmnopqrstuvwxyz0123456789-abcdefghi") == 0, "Long string value");
+    ASSERT(person.age == 42, "Value after long whitespace run");
+
+    const char* json2 = "{\"name\": \"Only \\\"quoted\\\" here\", \"age\": 7}";
+    bool result2 = parse_json(json2, mappings, 2, &error);
+    ASSERT(result2 && person.age == 7, "Escaped quote does not end a string");
+
+    const char* json3 = "{\"name\": \"This string never ends because the quote is missing}";
+    bool result3 = parse_json(json3, mappings, 2, &error);
+    ASSERT(!result3, "Unterminated long string detection");
+}
+
+void test_numbers() {
+    printf("\nTesting numbers:\n");
+    char* error = NULL;
+    struct {
+        int i;
+        int64_t ts;
+        uint64_t id;
+        float f;
+        double d;
+    } n;
+
+    JsonMap mappings[] = {
+        {"i", &n.i, 'i', 0, true, NULL},
+        {"ts", &n.ts, 'I', 0, true, NULL},
+        {"id", &n.id, 'U', 0, true, NULL},
+        {"f", &n.f, 'f', 0, true, NULL},
+        {"d", &n.d, 'd', 0, true, NULL}
+    };
+
+    const char* json = "{\"i\": -2147483648, \"ts\": 1700000000123456789, \"id\": 18446744073709551615,"
+                       " \"f\": 0.1, \"d\": -1.7976931348623157e308}";
+    bool result = parse_json(json, mappings, 5, &error);
+    ASSERT(result, "Number parsing");
+    ASSERT(n.i == INT_MIN, "Integer minimum value");
+    ASSERT(n.ts == 1700000000123456789LL, "64-bit signed integer");
+    ASSERT(n.id == UINT64_MAX, "64-bit unsigned integer");
+    ASSERT(n.f == 0.1f, "Float parsing");
+    ASSERT(n.d == -1.7976931348623157e308, "Double maximum magnitude");
+
+    const char* json2 = "{\"i\": 0, \"ts\": -9223372036854775808, \"id\": 0, \"f\": 1e-40,"
+                        " \"d\": 2.2250738585072011e-308}";
+    bool result2 = parse_json(json2, mappings, 5, &error);
+    ASSERT(result2 && n.ts == INT64_MIN, "64-bit signed minimum value");
+    ASSERT(n.d == 2.2250738585072011e-308 && n.f == 1e-40f, "Subnormal values");
+
+    const char* json3 = "{\"d\": 3.14159265358979323846264338327950288, \"i\": 1, \"ts\": 1, \"id\": 1, \"f\": 1}";
+    bool result3 = parse_json(json3, mappings, 5, &error);
+    ASSERT(result3 && n.d == 3.141592653589793, "Double with more than 19 digits");
+
+    // Long halfway cases take the exact slow path, which needs no heap
+    char long_json[256];
+    snprintf(long_json, sizeof(long_json), "{\"d\": 9007199254740993.%0150d1}", 0);
+    alloc_fail = true;
+    bool long_result = parse_json(long_json, &mappings[4], 1, &error);
+    alloc_fail = false;
+    ASSERT(long_result && n.d == 9007199254740994.0, "Long halfway double rounds up without allocating");
+    ASSERT(parse_json("{\"f\": 1.00000005960464477539062500001}", &mappings[3], 1, &error) &&
+           n.f == 1.00000012f, "Float slow path rounds once");
+    ASSERT(parse_json("{\"d\": 2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125e-324}",
+                      &mappings[4], 1, &error) && n.d == 0.0, "Exact half of the smallest subnormal rounds to even");
+
+    ASSERT(!parse_json("{\"i\": 2147483648}", mappings, 1, &error), "Integer overflow detection");
+    ASSERT(!parse_json("{\"ts\": 9223372036854775808}", &mappings[1], 1, &error), "64-bit overflow detection");
+    ASSERT(!parse_json("{\"id\": 18446744073709551616}", &mappings[2], 1, &error), "Unsigned overflow detection");
+    ASSERT(!parse_json("{\"id\": -1}", &mappings[2], 1, &error), "Negative unsigned detection");
+    ASSERT(!parse_json("{\"i\": 1.5}", mappings, 1, &error), "Fractional integer detection");
+    ASSERT(!parse_json("{\"i\": 012}", mappings, 1, &error), "Leading zero detection");
+    ASSERT(!parse_json("{\"d\": 1.}", &mappings[4], 1, &error), "Missing fraction digits detection");
+}
+
+typedef struct {
+    int64_t ts;
+    int id;
+    char tag[8];
+} TestRecord;
+
+void test_ndjson() {
+    printf("\nTesting NDJSON batches:\n");
+    char* error = NULL;
+
+    JsonMap fields[] = {
+        {"ts", JC_OFFSET(TestRecord, ts), 'I', 0, true, NULL},
+        {"id", JC_OFFSET(TestRecord, id), 'i', 0, true, NULL},
+        {"tag", JC_OFFSET(TestRecord, tag), 's', sizeof(((TestRecord*)0)->tag), false, NULL}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(fields, 3, &error);
+
+    const char* buf = "{\"ts\": 10, \"id\": 1, \"tag\": \"a\"}\n"
+                      "\n"
+                      "{\"ts\": 20, \"id\": 2}\r\n"
+                      "{\"ts\": 30, \"id\": }\n"
+                      "{\"ts\": 40, \"id\": 4, \"tag\": \"d\"}";
+    TestRecord records[8];
+    jc_record_error errors[4];
+    jc_ndjson_stats stats = {0};
+    stats.errors = errors;
+    stats.max_errors = 4;
+
+    size_t n = jc_parse_ndjson(schema, buf, strlen(buf), records, sizeof(TestRecord), 8, &stats);
+    ASSERT(n == 4 && stats.records == 4, "NDJSON record count skips blank lines");
+    ASSERT(records[0].ts == 10 && records[1].id == 2 && strcmp(records[3].tag, "d") == 0, "NDJSON record values");
+    ASSERT(stats.failed == 1 && stats.error_count == 1 && errors[0].record == 2, "NDJSON per-record error");
+    ASSERT(errors[0].offset == (size_t)(strstr(buf, "{\"ts\": 30") - buf), "NDJSON error offset");
+    ASSERT(stats.bytes_consumed == strlen(buf), "NDJSON consumes whole buffer");
+
+    n = jc_parse_ndjson(schema, buf, strlen(buf), records, sizeof(TestRecord), 2, &stats);
+    ASSERT(n == 2 && stats.bytes_consumed == (size_t)(strstr(buf, "{\"ts\": 30") - buf), "NDJSON stops at max_records");
+
+    // Multi-threaded parsing must match the serial result
+    enum { COUNT = 3000 };
+    static char big[COUNT * 48];
+    static TestRecord serial[COUNT];
+    static TestRecord parallel[COUNT];
+    char* out = big;
+    for (int i = 0; i < COUNT; i++) {
+        if (i % 500 == 7) {
+            out += sprintf(out, "{\"ts\": %d, \"id\": \"bad\"}\n", i);
+        } else {
+            out += sprintf(out, "{\"ts\": %d, \"id\": %d, \"tag\": \"t%d\"}\n", i * 1000, i, i % 100);
+        }
+    }
+    jc_record_error serial_errors[8];
+    jc_record_error parallel_errors[8];
+    jc_ndjson_stats serial_stats = {0};
+    jc_ndjson_stats parallel_stats = {0};
+    serial_stats.errors = serial_errors;
+    serial_stats.max_errors = 8;
+    parallel_stats.errors = parallel_errors;
+    parallel_stats.max_errors = 8;
+
+    size_t n1 = jc_parse_ndjson(schema, big, out - big, serial, sizeof(TestRecord), COUNT, &serial_stats);
+    size_t n2 = jc_parse_ndjson_mt(schema, big, out - big, parallel, sizeof(TestRecord), COUNT, 4, &parallel_stats);
+    ASSERT(n1 == COUNT && n2 == COUNT, "Multi-threaded NDJSON record count");
+    bool same = true;
+    for (int i = 0; i < COUNT; i++) {
+        if (i % 500 == 7) continue;
+        if (serial[i].ts != parallel[i].ts || serial[i].id != parallel[i].id ||
+            strcmp(serial[i].tag, parallel[i].tag) != 0) {
+            same = false;
+        }
+    }
+    ASSERT(same && parallel[2999].id == 2999, "Multi-threaded NDJSON matches serial output");
+    same = parallel_stats.error_count == serial_stats.error_count && parallel_stats.failed == 6;
+    for (size_t i = 0; same && i < serial_stats.error_count; i++) {
+        same = serial_errors[i].record == parallel_errors[i].record &&
+               serial_errors[i].offset == parallel_errors[i].offset;
+    }
+    ASSERT(same && parallel_errors[1].record == 507, "Multi-threaded NDJSON errors in record order");
+    jc_schema_free(schema);
+}
+
+typedef struct {
+    char name[32];
+    int age;
+    int64_t ts;
+    double gpa;
+    bool is_student;
+    TestAddress address;
+    char tags[3][20];
+} TestStreamed;
+
+// Feed json to a stream in chunks of the given sizes (cycled)
+static bool feed_chunks(const jc_schema* schema, TestStreamed* out, const char* json,
+                        size_t first, size_t rest, char** error) {
+    jc_stream stream;
+    if (!jc_stream_init(&stream, schema, out, error)) return false;
+    size_t len = strlen(json);
+    size_t pos = 0;
+    size_t chunk = first;
+    bool ok = true;
+    while (ok && pos < len) {
+        size_t n = chunk < len - pos ? chunk : len - pos;
+        ok = jc_stream_feed(&stream, json + pos, n, error);
+        pos += n;
+        chunk = rest;
+    }
+    return jc_stream_finish(&stream, error) && ok;
+}
+
+void test_stream() {
+    printf("\nTesting streaming parser:\n");
+    char* error = NULL;
+
+    JsonMap address_fields[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(((TestAddress*)0)->street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL}
+    };
+    JsonMap tag_item = {"item", NULL, 's', 20, false, NULL};
+    JsonMap fields[] = {
+        {"name", JC_OFFSET(TestStreamed, name), 's', sizeof(((TestStreamed*)0)->name), true, NULL},
+        {"age", JC_OFFSET(TestStreamed, age), 'i', 0, true, NULL},
+        {"ts", JC_OFFSET(TestStreamed, ts), 'I', 0, true, NULL},
+        {"gpa", JC_OFFSET(TestStreamed, gpa), 'd', 0, false, NULL},
+        {"is_student", JC_OFFSET(TestStreamed, is_student), 'b', 0, false, NULL},
+        {"address", JC_OFFSET(TestStreamed, address), 'o', 2, true, address_fields},
+        {"tags", JC_OFFSET(TestStreamed, tags), 'a', 3, false, &tag_item}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(fields, 7, &error);
+
+    const char* json = "{ \"name\": \"Stream \\\"er\\\"\", \"age\": -42, \"ts\": 1700000000123456789,\n"
+                       "  \"unknown\": {\"a\": [1, \"x}\", {\"b\": null}]}, \"skip\": \"s\\\"}\", \"n\": 12.5e3,\n"
+                       "  \"gpa\": 3.75, \"is_student\": true,\n"
+                       "  \"address\": {\"street\": \"Main\", \"number\": 9}, \"tags\": [\"a\", \"bb\", \"ccc\"] }\n";
+
+    TestStreamed whole;
+    bool result = feed_chunks(schema, &whole, json, strlen(json), 0, &error);
+    ASSERT(result, "Stream parsing in one chunk");
+    ASSERT(strcmp(whole.name, "Stream \"er\"") == 0 && whole.age == -42, "Stream string and integer");
+    ASSERT(whole.ts == 1700000000123456789LL && whole.gpa == 3.75 && whole.is_student, "Stream number and boolean");
+    ASSERT(strcmp(whole.address.street, "Main") == 0 && whole.address.number == 9, "Stream nested object");
+    ASSERT(strcmp(whole.tags[2], "ccc") == 0, "Stream array");
+
+    // Every split point, and one byte at a time
+    bool all_splits = true;
+    for (size_t split = 1; split < strlen(json); split++) {
+        TestStreamed part;
+        memset(&part, 0, sizeof(part));
+        if (!feed_chunks(schema, &part, json, split, strlen(json), &error) ||
+            strcmp(part.name, whole.name) != 0 || part.ts != whole.ts || part.gpa != whole.gpa ||
+            part.address.number != 9 || strcmp(part.tags[1], "bb") != 0) {
+            all_splits = false;
+        }
+    }
+    ASSERT(all_splits, "Stream parsing split at every byte");
+    TestStreamed bytes;
+    bool result2 = feed_chunks(schema, &bytes, json, 1, 1, &error);
+    ASSERT(result2 && bytes.age == -42 && strcmp(bytes.tags[0], "a") == 0, "Stream parsing one byte at a time");
+
+    // Errors
+    bool result3 = feed_chunks(schema, &bytes, "{\"name\": \"x\", \"age\": 1", 5, 5, &error);
+    ASSERT(!result3, "Stream detects truncated input");
+
+    jc_stream stream;
+    jc_stream_init(&stream, schema, &bytes, &error);
+    bool fed = jc_stream_feed(&stream, "{\"name\": \"x\",", 13, &error);
+    fed = fed && jc_stream_feed(&stream, " \"age\": tru", 11, &error);
+    bool finished = jc_stream_finish(&stream, &error);
+    ASSERT(!fed && !finished && stream.error_offset == 21, "Stream reports error offset");
+
+    bool result4 = feed_chunks(schema, &bytes, "{\"name\": \"x\", \"age\": 1, \"ts\": 2}", 3, 3, &error);
+    ASSERT(!result4, "Stream detects missing required field");
+    jc_schema_free(schema);
+}
+
+void test_length_bounded() {
+    printf("\nTesting length-bounded parsing:\n");
+    TestPerson person;
+    char* error = NULL;
+
+    JsonMap mappings[] = {
+        {"age", &person.age, 'i', 0, true, NULL},
+        {"name", &person.name, 's', sizeof(person.name), true, NULL}
+    };
+
+    // Exactly-sized heap buffer without a terminator
+    const char* text = "{\"name\": \"Bounded\", \"age\": 12345}";
+    size_t len = strlen(text);
+    char* buf = malloc(len);
+    memcpy(buf, text, len);
+    bool result = parse_json_n(buf, len, mappings, 2, &error);
+    ASSERT(result && person.age == 12345 && strcmp(person.name, "Bounded") == 0, "Parsing without NUL terminator");
+
+    bool result2 = parse_json_n(buf, len - 3, mappings, 2, &error);
+    ASSERT(!result2, "Truncated length detected");
+
+    bool result3 = parse_json_n(buf, 24, mappings, 2, &error);
+    ASSERT(!result3, "Length ending inside a number detected");
+    free(buf);
+
+    const char* slice = "{\"name\": \"A\", \"age\": 1}{\"name\": \"B\", \"age\": 2}";
+    bool result4 = parse_json_n(slice, 23, mappings, 2, &error);
+    ASSERT(result4 && strcmp(person.name, "A") == 0, "Parsing a slice of a larger buffer");
+
+    // Memory-mapped file
+    const char* path = "test_parse_file.json";
+    FILE* fp = fopen(path, "wb");
+    fputs("{\n  \"age\": 77,\n  \"name\": \"Mapped\"\n}\n", fp);
+    fclose(fp);
+
+    JsonMap fields[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"name", JC_OFFSET(TestPerson, name), 's', sizeof(((TestPerson*)0)->name), true, NULL}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(fields, 2, &error);
+    TestPerson loaded;
+    bool result5 = jc_parse_file(path, schema, &loaded, &error);
+    ASSERT(result5 && loaded.age == 77 && strcmp(loaded.name, "Mapped") == 0, "Parsing a memory-mapped file");
+    remove(path);
+
+    bool result6 = jc_parse_file(path, schema, &loaded, &error);
+    ASSERT(!result6, "Missing file detection");
+    jc_schema_free(schema);
+}
+
+void test_no_allocations() {
+    printf("\nTesting allocation-free parsing:\n");
+    TestPerson person;
+    char* error = NULL;
+
+    JsonMap address_mappings[] = {
+        {"street", &person.address.street, 's', sizeof(person.address.street), true, NULL},
+        {"number", &person.address.number, 'i', 0, true, NULL},
+        {"city", &person.address.city, 's', sizeof(person.address.city), false, NULL}
+    };
+    JsonMap score_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap mappings[] = {
+        {"age", &person.age, 'i', 0, true, NULL},
+        {"name", &person.name, 's', sizeof(person.name), true, NULL},
+        {"gpa", &person.gpa, 'd', 0, false, NULL},
+        {"address", &person.address, 'o', 3, true, address_mappings},
+        {"scores", person.scores, 'a', 5, true, &score_item}
+    };
+    const char* json = "{\"name\": \"John\", \"age\": 25, \"gpa\": 3.8,"
+                       " \"address\": {\"street\": \"Main St\", \"number\": 123, \"city\": \"New York\"},"
+                       " \"scores\": [85, 92, 88, 95, 90]}";
+
+    size_t before = alloc_count;
+    bool result = parse_json(json, mappings, 5, &error);
+    ASSERT(result && alloc_count == before, "parse_json makes no heap allocations");
+
+    jc_schema* schema = jc_schema_compile(mappings, 5, &error);
+    before = alloc_count;
+    bool result2 = parse_json_schema(json, schema, &error);
+    ASSERT(result2 && alloc_count == before, "Compiled schema parse makes no heap allocations");
+    jc_schema_free(schema);
+
+    // Objects wider than the stack bitmask reuse the scratch after warm-up
+    enum { WIDE = JC_STACK_FIELDS + 44 };
+    static int values[WIDE];
+    static char keys[WIDE][16];
+    static JsonMap wide[WIDE];
+    static char wide_json[WIDE * 24];
+    char* out = wide_json;
+    out += sprintf(out, "{");
+    for (int i = 0; i < WIDE; i++) {
+        sprintf(keys[i], "k%d", i);
+        wide[i] = (JsonMap){keys[i], &values[i], 'i', 0, i % 2 == 0, NULL};
+        out += sprintf(out, "%s\"k%d\": %d", i ? "," : "", i, i);
+    }
+    sprintf(out, "}");
+
+    schema = jc_schema_compile(wide, WIDE, &error);
+    jc_scratch scratch = {0};
+    jc_options opts = {&scratch, NULL, NULL, NULL, false, NULL};
+    bool result3 = parse_json_ex(schema, NULL, wide_json, strlen(wide_json), &opts, &error);
+    before = alloc_count;
+    bool result4 = parse_json_ex(schema, NULL, wide_json, strlen(wide_json), &opts, &error);
+    ASSERT(result3 && result4 && values[WIDE - 1] == WIDE - 1, "Wide object parsing with scratch");
+    ASSERT(alloc_count == before, "Steady-state wide parse makes no heap allocations");
+
+    bool result5 = parse_json_ex(schema, NULL, "{\"k1\": 1}", 9, &opts, &error);
+    ASSERT(!result5 && scratch.used == 0, "Scratch released after failed parse");
+    jc_scratch_free(&scratch);
+    jc_schema_free(schema);
+}
+
+void test_serialize() {
+    printf("\nTesting serialization:\n");
+    char* error = NULL;
+
+    JsonMap address_mappings[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(((TestAddress*)0)->street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL},
+        {"city", JC_OFFSET(TestAddress, city), 's', sizeof(((TestAddress*)0)->city), false, NULL}
+    };
+    JsonMap score_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap tag_item = {"item", NULL, 's', 20, false, NULL};
+    JsonMap mappings[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"name", JC_OFFSET(TestPerson, name), 's', sizeof(((TestPerson*)0)->name), true, NULL},
+        {"is_student", JC_OFFSET(TestPerson, is_student), 'b', 0, false, NULL},
+        {"gpa", JC_OFFSET(TestPerson, gpa), 'd', 0, false, NULL},
+        {"address", JC_OFFSET(TestPerson, address), 'o', 3, true, address_mappings},
+        {"scores", JC_OFFSET(TestPerson, scores), 'a', 5, true, &score_item},
+        {"tags", JC_OFFSET(TestPerson, tags), 'a', 3, false, &tag_item}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 7, &error);
+
+    TestPerson person = {
+        -42, "Jo \"Q\"\n\\", true, 3.8, {"Main St", 123, "New York"},
+        {85, -92, 0, 2147483647, -2147483647 - 1}, {"a", "\x01", ""}
+    };
+    const char* expected = "{\"age\":-42,\"name\":\"Jo \\\"Q\\\"\\n\\\\\",\"is_student\":true,\"gpa\":3.8,"
+                           "\"address\":{\"street\":\"Main St\",\"number\":123,\"city\":\"New York\"},"
+                           "\"scores\":[85,-92,0,2147483647,-2147483648],\"tags\":[\"a\",\"\\u0001\",\"\"]}";
+    char out[512];
+    size_t len = jc_serialize(schema, &person, out, sizeof(out));
+    ASSERT(len == strlen(expected) && strcmp(out, expected) == 0, "Serialize all field types");
+
+    TestPerson copy;
+    bool result = parse_json_into(schema, &copy, out, &error);
+    ASSERT(result && copy.age == -42 && copy.gpa == 3.8 && copy.scores[4] == INT_MIN &&
+           strcmp(copy.address.city, "New York") == 0, "Serialized output parses back");
+
+    char small[16];
+    size_t needed = jc_serialize(schema, &person, small, sizeof(small));
+    ASSERT(needed == len && strlen(small) == sizeof(small) - 1 &&
+           memcmp(small, expected, sizeof(small) - 1) == 0, "Truncated output reports full length");
+    ASSERT(jc_serialize(schema, &person, NULL, 0) == len, "Length query with no buffer");
+
+    jc_buffer buf = {0};
+    bool result2 = jc_serialize_buffer(schema, &person, &buf) &&
+                   jc_serialize_buffer(schema, &person, &buf);
+    ASSERT(result2 && buf.len == 2 * len && strcmp(buf.data + len, expected) == 0,
+           "Growable buffer appends documents");
+    jc_buffer_free(&buf);
+    jc_schema_free(schema);
+
+    // Wide numeric types and shortest round-trip floating point
+    struct { int64_t i64; uint64_t u64; double d[4]; float f; } nums = {
+        INT64_MIN, UINT64_MAX, {0.1, -1e-7, 1e300, 5e-324}, 0.1f
+    };
+    JsonMap num_mappings[] = {
+        {"i64", &nums.i64, 'I', 0, true, NULL},
+        {"u64", &nums.u64, 'U', 0, true, NULL},
+        {"f", &nums.f, 'f', 0, true, NULL},
+        {"d0", &nums.d[0], 'd', 0, true, NULL},
+        {"d1", &nums.d[1], 'd', 0, true, NULL},
+        {"d2", &nums.d[2], 'd', 0, true, NULL},
+        {"d3", &nums.d[3], 'd', 0, true, NULL},
+    };
+    schema = jc_schema_compile(num_mappings, 7, &error);
+    jc_serialize(schema, NULL, out, sizeof(out));
+    ASSERT(strcmp(out, "{\"i64\":-9223372036854775808,\"u64\":18446744073709551615,\"f\":0.1,"
+                       "\"d0\":0.1,\"d1\":-1e-7,\"d2\":1e300,\"d3\":5e-324}") == 0,
+           "Wide integers and shortest floating point");
+    jc_schema_free(schema);
+}
+
+void test_variable_arrays() {
+    printf("\nTesting variable-length arrays:\n");
+    char* error = NULL;
+    typedef struct {
+        int id;
+        jc_array values;
+        jc_array names;
+    } TestSeries;
+
+    JsonMap value_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap name_item = {"item", NULL, 's', 8, true, NULL};
+    JsonMap mappings[] = {
+        {"id", JC_OFFSET(TestSeries, id), 'i', 0, true, NULL},
+        {"values", JC_OFFSET(TestSeries, values), 'v', 0, true, &value_item},
+        {"names", JC_OFFSET(TestSeries, names), 'v', 3, false, &name_item}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 3, &error);
+
+    static char memory[1024];
+    jc_arena arena;
+    jc_arena_init(&arena, memory, sizeof(memory));
+    jc_options opts = {NULL, &arena, NULL, NULL, false, NULL};
+
+    char json[256];
+    char* out = json;
+    out += sprintf(out, "{\"id\": 7, \"values\": [");
+    for (int i = 0; i < 20; i++) out += sprintf(out, "%s%d", i ? ", " : "", i * i);
+    sprintf(out, "], \"names\": [\"a\", \"bb\"]}");
+
+    TestSeries series;
+    size_t before = alloc_count;
+    bool result = parse_json_ex(schema, &series, json, strlen(json), &opts, &error);
+    ASSERT(result && alloc_count == before, "Variable-length arrays parse without heap allocations");
+    ASSERT(series.values.count == 20 && ((int*)series.values.items)[19] == 361, "Int array grown in the arena");
+    ASSERT(series.names.count == 2 && strcmp((char*)series.names.items + 8, "bb") == 0, "String array in the arena");
+    ASSERT(arena.used <= 20 * sizeof(int) + 2 * 8 + 2 * _Alignof(max_align_t), "Arena keeps only used elements");
+
+    char written[256];
+    jc_serialize(schema, &series, written, sizeof(written));
+    ASSERT(strncmp(written, "{\"id\":7,\"values\":[0,1,4,9,", 25) == 0 &&
+           strstr(written, "\"names\":[\"a\",\"bb\"]}") != NULL, "Variable-length arrays serialize");
+
+    jc_arena_reset(&arena);
+    const char* empty = "{\"id\": 1, \"values\": []}";
+    bool result2 = parse_json_ex(schema, &series, empty, strlen(empty), &opts, &error);
+    ASSERT(result2 && series.values.count == 0 && arena.used == 0, "Empty array uses no arena memory");
+
+    const char* too_long = "{\"id\": 1, \"values\": [], \"names\": [\"a\", \"b\", \"c\", \"d\"]}";
+    bool result3 = parse_json_ex(schema, &series, too_long, strlen(too_long), &opts, &error);
+    ASSERT(!result3 && strcmp(error, "Array too long") == 0, "Element limit enforced");
+
+    jc_arena small;
+    jc_arena_init(&small, memory, 16);
+    opts.arena = &small;
+    bool result4 = parse_json_ex(schema, &series, json, strlen(json), &opts, &error);
+    ASSERT(!result4 && strcmp(error, "Arena exhausted") == 0, "Full arena reported");
+
+    bool result5 = parse_json_into(schema, &series, empty, &error);
+    ASSERT(!result5 && strcmp(error, "No arena for variable-length array") == 0, "Missing arena reported");
+    jc_schema_free(schema);
+}
+
+void test_string_views() {
+    printf("\nTesting string views:\n");
+    char* error = NULL;
+    typedef struct {
+        jc_str url;
+        jc_str agent;
+        jc_str trace;
+    } TestRequest;
+
+    JsonMap mappings[] = {
+        {"url", JC_OFFSET(TestRequest, url), 'S', 0, true, NULL},
+        {"agent", JC_OFFSET(TestRequest, agent), 'S', 0, true, NULL},
+        {"trace", JC_OFFSET(TestRequest, trace), 'S', 0, false, NULL}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 3, &error);
+
+    static char long_url[4096];
+    memset(long_url, 'x', sizeof(long_url) - 1);
+    char json[4300];
+    snprintf(json, sizeof(json),
+             "{\"url\": \"%s\", \"agent\": \"Tab\\there \\\"q\\\" \\u00e9\\ud83d\\ude00\", \"trace\": \"\"}",
+             long_url);
+
+    TestRequest req;
+    size_t before = alloc_count;
+    bool result = parse_json_into(schema, &req, json, &error);
+    ASSERT(result && alloc_count == before, "String views parse without copying");
+    ASSERT(req.url.len == sizeof(long_url) - 1 && req.url.ptr == strchr(json, 'x') && !req.url.escaped,
+           "Long string points into the input");
+    ASSERT(req.trace.len == 0 && !req.trace.escaped, "Empty string view");
+    ASSERT(req.agent.escaped, "Escaped string flagged");
+
+    char decoded[64];
+    size_t len = 0;
+    bool result2 = jc_str_decode(&req.agent, decoded, &len, &error);
+    ASSERT(result2 && strcmp(decoded, "Tab\there \"q\" \xc3\xa9\xf0\x9f\x98\x80") == 0 && len == strlen(decoded),
+           "Escapes and surrogate pairs decoded on demand");
+
+    char written[4400];
+    jc_serialize(schema, &req, written, sizeof(written));
+    ASSERT(strstr(written, "\"agent\":\"Tab\\there \\\"q\\\" \\u00e9\\ud83d\\ude00\"") != NULL,
+           "Escaped views serialize verbatim");
+
+    jc_str bad = {"\\ud83d", 6, true};
+    ASSERT(!jc_str_decode(&bad, decoded, &len, &error) && strcmp(error, "Invalid unicode escape") == 0,
+           "Lone surrogate rejected on decode");
+    jc_schema_free(schema);
+}
+
+void test_typed_arrays() {
+    printf("\nTesting typed and columnar arrays:\n");
+    char* error = NULL;
+    typedef struct {
+        char name[8];
+        double x;
+        bool on;
+    } TestPoint;
+    typedef struct {
+        size_t rows;
+        int64_t t[8];
+        double v[8];
+    } TestColumns;
+    typedef struct {
+        double weights[3];
+        bool flags[4];
+        TestPoint points[2];
+        int ids[3];
+        jc_array more;
+        TestColumns series;
+    } TestShapes;
+
+    JsonMap point_maps[] = {
+        {"name", JC_OFFSET(TestPoint, name), 's', 8, true, NULL},
+        {"x", JC_OFFSET(TestPoint, x), 'd', 0, true, NULL},
+        {"on", JC_OFFSET(TestPoint, on), 'b', 0, false, NULL}
+    };
+    JsonMap sample_maps[] = {
+        {"t", JC_OFFSET(TestColumns, t), 'I', 0, true, NULL},
+        {"v", JC_OFFSET(TestColumns, v), 'd', 0, true, NULL}
+    };
+    JsonMap double_item = {"item", NULL, 'd', 0, true, NULL};
+    JsonMap bool_item = {"item", NULL, 'b', 0, true, NULL};
+    JsonMap point_item = {"item", JC_STRIDE(sizeof(TestPoint)), 'o', 3, true, point_maps};
+    JsonMap scatter_item = {"item", JC_STRIDE(sizeof(TestPoint)), 'd', 0, true, NULL};
+    JsonMap id_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap row_item = {"row", NULL, 'o', 2, true, sample_maps};
+    JsonMap mappings[] = {
+        {"weights", JC_OFFSET(TestShapes, weights), 'a', 3, true, &double_item},
+        {"flags", JC_OFFSET(TestShapes, flags), 'a', 4, true, &bool_item},
+        {"points", JC_OFFSET(TestShapes, points), 'a', 2, true, &point_item},
+        {"ids", JC_OFFSET(TestShapes, ids), 'a', 3, false, &id_item},
+        {"more", JC_OFFSET(TestShapes, more), 'v', 0, false, &point_item},
+        {"series", JC_OFFSET(TestShapes, series), 'c', 8, false, &row_item}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 6, &error);
+    ASSERT(schema != NULL, "Typed array schema compilation");
+
+    const char* json = "{\"weights\": [0.5, -1.25, 3e10], \"flags\": [true, false, false, true],"
+                       " \"points\": [{\"name\": \"a\", \"x\": 1.5, \"on\": true}, {\"x\": -2, \"name\": \"b\"}],"
+                       " \"more\": [{\"name\": \"c\", \"x\": 9}],"
+                       " \"series\": [{\"t\": 1000, \"v\": 0.25}, {\"v\": 0.5, \"t\": 1001}, {\"t\": 1002, \"v\": 0.75}]}";
+    static char memory[256];
+    jc_arena arena;
+    jc_arena_init(&arena, memory, sizeof(memory));
+    jc_options opts = {NULL, &arena, NULL, NULL, false, NULL};
+    TestShapes shapes;
+    memset(&shapes, 0, sizeof(shapes));
+    bool result = parse_json_ex(schema, &shapes, json, strlen(json), &opts, &error);
+    ASSERT(result, "Arrays of doubles, bools and objects parse");
+    ASSERT(shapes.weights[1] == -1.25 && shapes.weights[2] == 3e10, "Double array elements");
+    ASSERT(shapes.flags[0] && !shapes.flags[1] && !shapes.flags[2] && shapes.flags[3], "Bool array elements");
+    ASSERT(strcmp(shapes.points[1].name, "b") == 0 && shapes.points[1].x == -2 && shapes.points[0].on,
+           "Object array elements at their stride");
+    ASSERT(shapes.more.count == 1 && ((TestPoint*)shapes.more.items)->x == 9, "Variable-length array of objects");
+    ASSERT(shapes.series.rows == 3 && shapes.series.t[2] == 1002 && shapes.series.v[1] == 0.5,
+           "Columnar array fills contiguous columns");
+
+    char written[512];
+    jc_serialize(schema, &shapes, written, sizeof(written));
+    TestShapes copy;
+    memset(&copy, 0, sizeof(copy));
+    jc_arena_reset(&arena);
+    bool result2 = parse_json_ex(schema, &copy, written, strlen(written), &opts, &error);
+    ASSERT(result2 && copy.series.v[2] == 0.75 && copy.points[0].x == 1.5 && copy.flags[3],
+           "Typed arrays round-trip through the serializer");
+
+    const char* too_many = "{\"weights\": [0, 0, 0], \"flags\": [true, true, true, true],"
+                           " \"points\": [{\"name\": \"a\", \"x\": 1}, {\"name\": \"b\", \"x\": 2}],"
+                           " \"series\": [{\"t\": 1, \"v\": 1}, {\"t\": 1, \"v\": 1}, {\"t\": 1, \"v\": 1},"
+                           " {\"t\": 1, \"v\": 1}, {\"t\": 1, \"v\": 1}, {\"t\": 1, \"v\": 1}, {\"t\": 1, \"v\": 1},"
+                           " {\"t\": 1, \"v\": 1}, {\"t\": 1, \"v\": 1}]}";
+    bool result3 = parse_json_ex(schema, &copy, too_many, strlen(too_many), &opts, &error);
+    ASSERT(!result3 && strcmp(error, "Array too long") == 0, "Column capacity enforced");
+
+    // Explicit stride scatters elements into a field of each struct
+    TestPoint scattered[3];
+    JsonMap scatter_maps[] = {
+        {"xs", &scattered[0].x, 'a', 3, true, &scatter_item}
+    };
+    bool result4 = parse_json("{\"xs\": [1, 2, 3]}", scatter_maps, 1, &error);
+    ASSERT(result4 && scattered[0].x == 1 && scattered[2].x == 3, "Strided scalar array");
+
+    // Arrays of objects without a compiled schema
+    TestPoint points[2];
+    JsonMap legacy_maps[] = {
+        {"points", points, 'a', 2, true, &point_item}
+    };
+    bool result5 = parse_json("{\"points\": [{\"name\": \"p\", \"x\": 1}, {\"name\": \"q\", \"x\": 2}]}",
+                              legacy_maps, 1, &error);
+    ASSERT(result5 && strcmp(points[1].name, "q") == 0 && points[1].x == 2, "Object array without schema");
+
+    jc_schema* legacy_schema = jc_schema_compile(legacy_maps, 1, &error);
+    jc_stream stream;
+    const char* streamed = "{\"points\": [{\"name\": \"s\", \"x\": 3}, {\"name\": \"t\", \"x\": 4}]}";
+    jc_stream_init(&stream, legacy_schema, NULL, &error);
+    bool result6 = jc_stream_feed(&stream, streamed, 20, &error) &&
+                   jc_stream_feed(&stream, streamed + 20, strlen(streamed) - 20, &error);
+    result6 = jc_stream_finish(&stream, &error) && result6;
+    ASSERT(result6 && strcmp(points[0].name, "s") == 0 && points[1].x == 4, "Object array streamed");
+    jc_schema_free(legacy_schema);
+
+    JsonMap no_stride = {"item", NULL, 'o', 3, true, point_maps};
+    JsonMap bad_maps[] = {
+        {"points", points, 'a', 2, true, &no_stride}
+    };
+    ASSERT(jc_schema_compile(bad_maps, 1, &error) == NULL && strcmp(error, "Missing array item stride") == 0,
+           "Object items without a stride rejected");
+    jc_schema_free(schema);
+}
+
+void test_skip_unknown() {
+    printf("\nTesting skipping of unmapped values:\n");
+    char* error = NULL;
+    int id = 0;
+    char name[16];
+    JsonMap mappings[] = {
+        {"id", &id, 'i', 0, true, NULL},
+        {"name", name, 's', sizeof(name), true, NULL}
+    };
+    jc_schema* schema = jc_schema_compile(mappings, 2, &error);
+
+    const char* json = "{\"version\": 3, \"flag\": true, \"note\": \"has } and ] inside\","
+                       " \"meta\": {\"tags\": [\"{\", \"\\\"]\"], \"deep\": [[{}], {\"x\": null}]},"
+                       " \"id\": 42, \"empty\": [], \"name\": \"Ann\", \"ratio\": -1.5e3}";
+    bool result = parse_json(json, mappings, 2, &error);
+    ASSERT(result && id == 42 && strcmp(name, "Ann") == 0, "Unmapped scalars, strings and containers skipped");
+
+    jc_index index = {0};
+    jc_options opts = {NULL, NULL, &index, NULL, false, NULL};
+    id = 0;
+    bool result2 = parse_json_ex(schema, NULL, json, strlen(json), &opts, &error);
+    ASSERT(result2 && id == 42 && strcmp(name, "Ann") == 0, "Parsing with a structural index");
+    ASSERT(index.count == 16 && (uint32_t)index.entries[0] == 0 &&
+           (index.entries[0] >> 32) == 15, "Index pairs brackets outside strings");
+
+    // Long input crosses many 64-byte blocks, with strings spanning them
+    static char big[8192];
+    char* out = big;
+    out += sprintf(out, "{");
+    for (int i = 0; i < 60; i++) {
+        out += sprintf(out, "\"skip%d\": {\"s\": \"%*s\\\\\", \"a\": [%d, {\"b\": \"]\"}]},", i, i, "]", i);
+    }
+    sprintf(out, "\"name\": \"Bo\", \"id\": 7}");
+    size_t before = alloc_count;
+    bool result3 = parse_json_ex(schema, NULL, big, strlen(big), &opts, &error);
+    bool result4 = parse_json(big, mappings, 2, &error);
+    ASSERT(result3 && result4 && id == 7 && strcmp(name, "Bo") == 0, "Indexed and scanned skipping agree");
+    ASSERT(alloc_count - before <= 1, "Index memory reused");
+
+    const char* unbalanced = "{\"x\": [1, 2}, \"id\": 1, \"name\": \"a\"}";
+    jc_index_build(&index, unbalanced, strlen(unbalanced), &error);
+    ASSERT(index.count == 0, "Unbalanced input leaves the index empty");
+    jc_index_free(&index);
+    jc_schema_free(schema);
+}
+
+void test_stats() {
+    printf("\nTesting parse statistics and hooks:\n");
+    char* error = NULL;
+    TestPerson person;
+    JsonMap address_maps[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(person.address.street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL}
+    };
+    JsonMap score_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap mappings[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"address", JC_OFFSET(TestPerson, address), 'o', 2, true, address_maps},
+        {"scores", JC_OFFSET(TestPerson, scores), 'a', 2, false, &score_item}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 3, &error);
+
+    const char* json = "{\"age\": 30, \"extra\": {\"a\": [1]}, \"scores\": [1, 2],\n"
+                       " \"address\": {\"street\": \"Elm\", \"number\": 4, \"zip\": 1}}";
+    jc_stats stats;
+    jc_options opts = {NULL, NULL, NULL, &stats, false, NULL};
+    size_t parses = hook_parses, fields = hook_fields, skips = hook_skips;
+    bool result = parse_json_ex(schema, &person, json, strlen(json), &opts, &error);
+    ASSERT(result && stats.bytes == strlen(json) && stats.error_line == 0, "Successful parse consumes all input");
+    ASSERT(result && strcmp(person.address.street, "Elm") == 0 && person.address.number == 4,
+           "Nested values stored at their offsets");
+    ASSERT(stats.fields_matched == 5 && stats.keys_skipped == 2, "Matched and skipped keys counted");
+    ASSERT(stats.max_depth == 2 && stats.allocations == 0, "Depth and allocations reported");
+    ASSERT(hook_parses == parses + 1 && hook_fields - fields == 5 && hook_skips - skips == 2 &&
+           hook_last_fields == 5,
+           "Hooks called around the parse and per key");
+
+    const char* bad = "{\"age\": 30,\n  \"scores\": [1, x]}";
+    size_t failures = hook_failures;
+    bool result2 = parse_json_ex(schema, &person, bad, strlen(bad), &opts, &error);
+    ASSERT(!result2 && stats.error_offset == (size_t)(strchr(bad, 'x') - bad), "Error offset reported");
+    ASSERT(stats.error_line == 2 && stats.error_column == 17, "Error line and column reported");
+    ASSERT(hook_failures == failures + 1, "End hook sees the failure");
+    jc_schema_free(schema);
+}
+
+void test_key_prediction() {
+    printf("\nTesting key-order prediction:\n");
+    char* error = NULL;
+    TestPerson person;
+    JsonMap address_maps[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(person.address.street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL}
+    };
+    JsonMap mappings[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"name", JC_OFFSET(TestPerson, name), 's', sizeof(person.name), true, NULL},
+        {"gpa", JC_OFFSET(TestPerson, gpa), 'd', 0, false, NULL},
+        {"address", JC_OFFSET(TestPerson, address), 'o', 2, true, address_maps}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 4, &error);
+    ASSERT(schema && jc_schema_predict(schema, &error), "Prediction enabled");
+
+    const char* json = "{\"name\": \"Ann\", \"address\": {\"number\": 4, \"street\": \"Elm\"}, \"age\": 30}";
+    bool result = parse_json_ex(schema, &person, json, strlen(json), NULL, &error);
+    uint64_t hits = 0, misses = 0;
+    jc_schema_predict_stats(schema, &hits, &misses);
+    ASSERT(result && hits == 0 && misses == 5, "First document trains the prediction");
+
+    memset(&person, 0, sizeof(person));
+    bool result2 = parse_json_ex(schema, &person, json, strlen(json), NULL, &error);
+    hits = misses = 0;
+    jc_schema_predict_stats(schema, &hits, &misses);
+    ASSERT(result2 && hits == 5 && misses == 5 && person.age == 30 && person.address.number == 4 &&
+           strcmp(person.address.street, "Elm") == 0, "Stable order is matched by prediction");
+
+    // A different order and an unknown key still parse through the full lookup
+    const char* reordered = "{\"age\": 31, \"x\": 1, \"address\": {\"street\": \"Oak\", \"number\": 5},"
+                            " \"name\": \"Bo\", \"gpa\": 3.5}";
+    bool result3 = parse_json_ex(schema, &person, reordered, strlen(reordered), NULL, &error);
+    hits = misses = 0;
+    jc_schema_predict_stats(schema, &hits, &misses);
+    ASSERT(result3 && person.age == 31 && strcmp(person.name, "Bo") == 0 && person.gpa == 3.5 &&
+           person.address.number == 5 && misses == 12, "Prediction misses fall back to lookup");
+    jc_schema_free(schema);
+
+    // Threads share one predicting schema
+    JsonMap fields[] = {
+        {"ts", JC_OFFSET(TestRecord, ts), 'I', 0, true, NULL},
+        {"id", JC_OFFSET(TestRecord, id), 'i', 0, true, NULL},
+        {"tag", JC_OFFSET(TestRecord, tag), 's', sizeof(((TestRecord*)0)->tag), false, NULL}
+    };
+    jc_schema* records_schema = jc_schema_compile_offsets(fields, 3, &error);
+    jc_schema_predict(records_schema, &error);
+    enum { COUNT = 2000 };
+    static char big[COUNT * 48];
+    static TestRecord records[COUNT];
+    char* out = big;
+    for (int i = 0; i < COUNT; i++) {
+        out += sprintf(out, "{\"ts\": %d, \"id\": %d, \"tag\": \"t%d\"}\n", i * 1000, i, i % 100);
+    }
+    size_t n = jc_parse_ndjson_mt(records_schema, big, out - big, records, sizeof(TestRecord), COUNT, 4, NULL);
+    hits = misses = 0;
+    jc_schema_predict_stats(records_schema, &hits, &misses);
+    ASSERT(n == COUNT && records[COUNT - 1].id == COUNT - 1 && hits + misses == 3 * COUNT && hits >= 3 * COUNT - 12,
+           "Prediction shared across threads");
+    jc_schema_free(records_schema);
+}
+
+void test_path_queries() {
+    printf("\nTesting path queries:\n");
+    char* error = NULL;
+    const char* json = "{\"id\": 7, \"skip\": {\"city\": \"no\", \"deep\": [[{\"x\": \"}\"}]]},"
+                       " \"address\": {\"street\": \"Elm\", \"city\": \"Oslo\"},"
+                       " \"items\": [{\"id\": 1}, {\"id\": 2, \"tags\": [\"a\", \"b\"]}], \"age\": 41, \"n\": null}";
+    size_t len = strlen(json);
+
+    jc_value value;
+    bool result = jc_get_path(json, len, "address.city", &value, &error);
+    ASSERT(result && value.type == 's' && value.len == 6 && memcmp(value.ptr, "\"Oslo\"", 6) == 0,
+           "Path query finds a nested string");
+    bool result2 = jc_get_path(json, len, "items.1.tags.1", &value, &error);
+    ASSERT(result2 && value.type == 's' && memcmp(value.ptr, "\"b\"", 3) == 0, "Path query indexes arrays");
+    bool result3 = jc_get_path(json, len, "items.0", &value, &error);
+    ASSERT(result3 && value.type == 'o' && value.len == 9, "Path query returns whole objects");
+    bool result4 = jc_get_path(json, len, "n", &value, &error);
+    ASSERT(result4 && value.type == 'n', "Path query reports null");
+    bool result5 = jc_get_path(json, len, "address.zip", &value, &error);
+    ASSERT(!result5 && strcmp(error, "Path not found") == 0, "Missing path reported");
+
+    // The query stops at the value; what follows is never read
+    const char* truncated = "{\"a\": {\"b\": 5}, \"c\": [1, 2";
+    bool result6 = jc_get_path(truncated, strlen(truncated), "a.b", &value, &error);
+    ASSERT(result6 && value.type == 'd' && value.len == 1 && *value.ptr == '5', "Path query stops once found");
+
+    int age = 0, id = 0, item = 0;
+    char city[16] = "";
+    double missing = -1;
+    JsonMap paths[] = {
+        {"address.city", city, 's', sizeof(city), true, NULL},
+        {"age", &age, 'i', 0, true, NULL},
+        {"items.1.id", &item, 'i', 0, true, NULL},
+        {"id", &id, 'i', 0, true, NULL},
+        {"gpa", &missing, 'd', 0, false, NULL}
+    };
+    bool result7 = jc_get_paths(json, len, paths, 5, &error);
+    ASSERT(result7 && strcmp(city, "Oslo") == 0 && age == 41 && item == 2 && id == 7 && missing == -1,
+           "Multi-path query parses typed values");
+    paths[4].required = true;
+    bool result8 = jc_get_paths(json, len, paths, 5, &error);
+    ASSERT(!result8 && strcmp(error, "Missing required field") == 0, "Multi-path query checks required paths");
+    bool result9 = jc_get_paths(truncated, strlen(truncated), paths + 1, 1, &error);
+    ASSERT(!result9, "Malformed input before a path is an error");
+
+    // Stop once every top-level mapping is filled
+    int a = 0, b = 0;
+    JsonMap mappings[] = {
+        {"a", &a, 'i', 0, true, NULL},
+        {"b", &b, 'i', 0, true, NULL}
+    };
+    jc_schema* schema = jc_schema_compile(mappings, 2, &error);
+    const char* early = "{\"b\": 2, \"x\": {}, \"a\": 1, \"rest\": [unparsed";
+    jc_stats stats;
+    jc_options opts = {NULL, NULL, NULL, &stats, true, NULL};
+    bool result10 = parse_json_ex(schema, NULL, early, strlen(early), &opts, &error);
+    ASSERT(result10 && a == 1 && b == 2 && stats.bytes == (size_t)(strstr(early, ", \"rest") - early),
+           "Parse stops when all mappings are filled");
+    opts.stop_when_complete = false;
+    bool result11 = parse_json_ex(schema, NULL, early, strlen(early), &opts, &error);
+    ASSERT(!result11, "Without the flag the whole document is read");
+    jc_schema_free(schema);
+}
+
+void test_parallel_array() {
+    printf("\nTesting parallel array parsing:\n");
+    char* error = NULL;
+    JsonMap fields[] = {
+        {"ts", JC_OFFSET(TestRecord, ts), 'I', 0, true, NULL},
+        {"id", JC_OFFSET(TestRecord, id), 'i', 0, true, NULL},
+        {"tag", JC_OFFSET(TestRecord, tag), 's', sizeof(((TestRecord*)0)->tag), false, NULL}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(fields, 3, &error);
+
+    enum { COUNT = 20000 };
+    static char big[COUNT * 64];
+    static TestRecord serial[COUNT];
+    static TestRecord parallel[COUNT];
+    char* out = big;
+    out += sprintf(out, " [\n");
+    for (int i = 0; i < COUNT; i++) {
+        // Uneven element sizes give the workers unequal shares to steal
+        out += sprintf(out, "%s{\"ts\": %d, \"id\": %d, \"tag\": \"%.*s\", \"x\": [%s]}", i ? ",\n" : "",
+                       i * 3, i, i % 7, "abcdefg", i % 1000 < 100 ? "{\"a\": [1, 2, 3]}, {}" : "");
+    }
+    out += sprintf(out, "\n] ");
+    size_t len = out - big;
+
+    size_t n1 = 0, n2 = 0, element = 0;
+    bool result = jc_parse_array_mt(schema, big, len, serial, sizeof(TestRecord), COUNT, 1, &n1, &element, &error);
+    bool result2 = jc_parse_array_mt(schema, big, len, parallel, sizeof(TestRecord), COUNT, 4, &n2, &element, &error);
+    ASSERT(result && result2 && n1 == COUNT && n2 == COUNT, "Parallel array element count");
+    bool same = true;
+    for (int i = 0; i < COUNT; i++) {
+        if (parallel[i].id != i || parallel[i].ts != serial[i].ts || strcmp(parallel[i].tag, serial[i].tag) != 0) {
+            same = false;
+        }
+    }
+    ASSERT(same, "Parallel array output is ordered and matches a serial parse");
+
+    // The lowest failing element is reported, whichever worker found it
+    char* second = strstr(big, "\"id\": 15000,") + 6;
+    char* first = strstr(big, "\"id\": 9000,") + 6;
+    memcpy(second, "\"x\"", 3);
+    memcpy(first, "\"y\"", 3);
+    bool result3 = jc_parse_array_mt(schema, big, len, parallel, sizeof(TestRecord), COUNT, 4, &n2, &element, &error);
+    ASSERT(!result3 && element == 9000 && strcmp(error, "Invalid integer value") == 0 && n2 == 0,
+           "Parallel array reports the first failing element");
+    memcpy(first, "9000", 4);
+    memcpy(second, "1500", 4);
+
+    bool result4 = jc_parse_array_mt(schema, big, len, parallel, sizeof(TestRecord), COUNT - 1, 4, &n2, &element, &error);
+    ASSERT(!result4 && element == COUNT - 1 && strcmp(error, "Array too long") == 0, "Parallel array bounds output");
+
+    const char* gap = "[{\"ts\": 1, \"id\": 1}, 5, {\"ts\": 2, \"id\": 2}]";
+    bool result5 = jc_parse_array_mt(schema, gap, strlen(gap), parallel, sizeof(TestRecord), 8, 2, &n2, &element, &error);
+    ASSERT(!result5 && element == 1 && strcmp(error, "Expected object") == 0, "Non-object elements rejected");
+    const char* trailing = "[{\"ts\": 1, \"id\": 1},]";
+    bool result6 = jc_parse_array_mt(schema, trailing, strlen(trailing), parallel, sizeof(TestRecord), 8, 2, &n2,
+                                     &element, &error);
+    ASSERT(!result6 && element == 1 && strcmp(error, "Trailing comma") == 0, "Trailing comma rejected");
+    const char* empty = " [ ] ";
+    bool result7 = jc_parse_array_mt(schema, empty, strlen(empty), parallel, sizeof(TestRecord), 8, 2, &n2,
+                                     &element, &error);
+    const char* object = "{\"ts\": 1}";
+    bool result8 = jc_parse_array_mt(schema, object, strlen(object), parallel, sizeof(TestRecord), 8, 2, &n2,
+                                     &element, &error);
+    ASSERT(result7 && n2 == 0 && !result8 && element == SIZE_MAX && strcmp(error, "Expected array") == 0,
+           "Empty and non-array documents");
+    jc_schema_free(schema);
+}
+
+void test_document_tape() {
+    printf("\nTesting schemaless documents:\n");
+    char* error = NULL;
+    static char memory[8192];
+    jc_arena arena;
+    jc_arena_init(&arena, memory, sizeof(memory));
+
+    const char* json = " {\"na\\u006De\": \"Ann\\n\", \"age\": 30, \"big\": 18446744073709551615, \"neg\": -9223372036854775808,"
+                       " \"pi\": 3.25e0, \"ok\": true, \"none\": null, \"tags\": [\"a\", [], {}, [1, [2]]],"
+                       " \"address\": {\"street\": \"Elm\", \"number\": 4, \"extra\": [1, 2, 3]}} ";
+    jc_doc doc;
+    bool result = jc_doc_parse(&doc, json, strlen(json), &arena, &error);
+    jc_cursor root = jc_doc_root(&doc);
+    ASSERT(result && jc_cursor_type(root) == 'o' && jc_cursor_count(root) == 9, "Document parsed to a tape");
+
+    jc_str name;
+    int64_t age = 0, neg = 0;
+    uint64_t big = 0;
+    double pi = 0;
+    bool ok = false;
+    ASSERT(jc_cursor_str(jc_cursor_find(root, "name"), &name) && name.len == 5 && name.escaped &&
+           memcmp(name.ptr, "Ann\\n", 5) == 0, "String values point into the input");
+    ASSERT(jc_cursor_type(jc_cursor_find(root, "na\\u006De")) == 0, "Escaped keys are found by their decoded text");
+    char spelled[300];
+    char* w = spelled + sprintf(spelled, "{\"");
+    for (int i = 0; i < 44; i++) w += sprintf(w, "\\u%04x", 'k');
+    sprintf(w, "\": 1}");
+    jc_doc spelled_doc;
+    ASSERT(jc_doc_parse(&spelled_doc, spelled, strlen(spelled), &arena, &error) &&
+           jc_cursor_type(jc_cursor_find(jc_doc_root(&spelled_doc), "kkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkk")) == 'I',
+           "Keys are matched by decoded length, not escaped length");
+    ASSERT(jc_cursor_int64(jc_cursor_find(root, "age"), &age) && age == 30 &&
+           jc_cursor_int64(jc_cursor_find(root, "neg"), &neg) && neg == INT64_MIN &&
+           jc_cursor_type(jc_cursor_find(root, "big")) == 'U' &&
+           jc_cursor_uint64(jc_cursor_find(root, "big"), &big) && big == UINT64_MAX, "Integers keep 64 bits");
+    ASSERT(jc_cursor_double(jc_cursor_find(root, "pi"), &pi) && pi == 3.25 &&
+           jc_cursor_bool(jc_cursor_find(root, "ok"), &ok) && ok &&
+           jc_cursor_type(jc_cursor_find(root, "none")) == 'n' &&
+           jc_cursor_type(jc_cursor_find(root, "missing")) == 0, "Doubles, literals and missing keys");
+
+    jc_cursor tags = jc_cursor_find(root, "tags");
+    int64_t two = 0;
+    ASSERT(jc_cursor_count(tags) == 4 && jc_cursor_type(jc_cursor_at(tags, 1)) == 'a' &&
+           jc_cursor_count(jc_cursor_at(tags, 2)) == 0 && jc_cursor_type(jc_cursor_at(tags, 4)) == 0 &&
+           jc_cursor_int64(jc_cursor_at(jc_cursor_at(jc_cursor_at(tags, 3), 1), 0), &two) && two == 2,
+           "Arrays indexed with containers skipped in O(1)");
+
+    // Walk every member: keys and values alternate
+    size_t members = 0;
+    for (jc_cursor k = jc_cursor_first(root); jc_cursor_type(k); k = jc_cursor_next(jc_cursor_next(k))) {
+        members++;
+    }
+    ASSERT(members == 9, "Cursor iterates object members");
+
+    // Bind a subtree to a typed schema
+    TestAddress address;
+    JsonMap address_maps[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(address.street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(address_maps, 2, &error);
+    bool result2 = jc_cursor_bind(jc_cursor_find(root, "address"), schema, &address, NULL, &error);
+    ASSERT(result2 && strcmp(address.street, "Elm") == 0 && address.number == 4, "Subtree bound to a schema");
+    bool result3 = jc_cursor_bind(tags, schema, &address, NULL, &error);
+    ASSERT(!result3 && strcmp(error, "Expected object") == 0, "Only objects bind");
+    jc_schema_free(schema);
+
+    const char* bad[] = {"{\"a\": [1, 2,]}", "{\"a\": 1,}", "{\"a\" 1}", "[1 2]", "[tru]", "{} x", "[01]"};
+    const char* messages[] = {"Trailing comma", "Trailing comma", "Expected :", "Expected , or ]",
+                              "Invalid value", "Unexpected content after value", NULL};
+    bool all = true;
+    for (int i = 0; i < 7; i++) {
+        jc_arena_reset(&arena);
+        if (jc_doc_parse(&doc, bad[i], strlen(bad[i]), &arena, &error) ||
+            (messages[i] && strcmp(error, messages[i]) != 0)) {
+            printf("  %s: %s\n", bad[i], error);
+            all = false;
+        }
+    }
+    ASSERT(all, "Malformed documents rejected");
+
+    char tiny[64];
+    jc_arena small;
+    jc_arena_init(&small, tiny, sizeof(tiny));
+    bool result4 = jc_doc_parse(&doc, json, strlen(json), &small, &error);
+    ASSERT(!result4 && strcmp(error, "Arena exhausted") == 0, "Tape bounded by the arena");
+}
+
+void test_validate() {
+    printf("\nTesting validate-only mode:\n");
+    char* error = NULL;
+    JsonMap address_mappings[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(((TestAddress*)0)->street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL},
+    };
+    JsonMap score_item = {"item", NULL, 'i', 0, true, NULL};
+    JsonMap tag_item = {"item", NULL, 's', 20, false, NULL};
+    JsonMap mappings[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"name", JC_OFFSET(TestPerson, name), 's', 16, true, NULL},
+        {"gpa", JC_OFFSET(TestPerson, gpa), 'd', 0, false, NULL},
+        {"is_student", JC_OFFSET(TestPerson, is_student), 'b', 0, false, NULL},
+        {"address", JC_OFFSET(TestPerson, address), 'o', 2, false, address_mappings},
+        {"scores", JC_OFFSET(TestPerson, scores), 'a', 3, false, &score_item},
+        {"tags", JC_OFFSET(TestPerson, tags), 'v', 2, false, &tag_item},
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 7, &error);
+
+    const char* json = "{\"name\": \"Zo\\u00eb \u00e9\", \"age\": 30, \"gpa\": 3.5, \"is_student\": false,"
+                       " \"address\": {\"street\": \"Elm\", \"number\": 4}, \"scores\": [1, 2, 3],"
+                       " \"tags\": [\"a\"], \"extra\": {\"k\": [null, true, -1.5e3, \"\\ud83d\\ude00\"]}}";
+    bool result = jc_validate(schema, json, strlen(json), &error);
+    ASSERT(result, "Valid document accepted without a destination");
+
+    const char* bad[] = {
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": [1 2]}",
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": [1,]}",
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": 01}",
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": tru}",
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": \"\\x\"}",
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": \"\\ud83d\"}",
+        "{\"name\": \"Al\", \"age\": 1, \"extra\": \"\xc0\xaf\"}",
+        "{\"name\": \"Al\", \"age\": 1, \"ex\xedtra\": 2}",
+        "{\"name\": \"A\tl\", \"age\": 1}",
+        "{\"name\": \"Alexander the Great\", \"age\": 1}",
+        "{\"name\": \"Al\", \"age\": 3000000000}",
+        "{\"name\": \"Al\", \"age\": \"1\"}",
+        "{\"name\": \"Al\"}",
+        "{\"name\": \"Al\", \"age\": 1, \"address\": {\"street\": \"Elm\"}}",
+        "{\"name\": \"Al\", \"age\": 1, \"scores\": [1, 2]}",
+        "{\"name\": \"Al\", \"age\": 1, \"scores\": [1, 2, 3, 4]}",
+        "{\"name\": \"Al\", \"age\": 1, \"scores\": [1, 2 3]}",
+        "{\"name\": \"Al\", \"age\": 1, \"tags\": [\"a\", \"b\", \"c\"]}",
+        "{\"name\": \"Al\", \"age\": 1} x",
+    };
+    const char* messages[] = {
+        "Expected , or ]", "Trailing comma", "Invalid value", "Invalid value", "Invalid escape sequence",
+        "Invalid unicode escape", "Invalid UTF-8", "Invalid UTF-8", "Control character in string",
+        "String too long", "Integer out of range", "Invalid integer value", "Missing required field",
+        "Missing required field in nested object", "Array too short", "Array too long", "Expected , or ]",
+        "Array too long", "Unexpected content after }",
+    };
+    bool all = true;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (jc_validate(schema, bad[i], strlen(bad[i]), &error) || strcmp(error, messages[i]) != 0) {
+            printf("  %s: %s\n", bad[i], error);
+            all = false;
+        }
+    }
+    ASSERT(all, "Grammar, encoding and schema violations rejected");
+
+    // Strings long enough for the vector scan, with a bad byte late in the run
+    char long_json[256];
+    snprintf(long_json, sizeof(long_json), "{\"name\": \"Al\", \"age\": 1, \"note\": \"%s\xff\"}",
+             "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz");
+    bool result2 = jc_validate(schema, long_json, strlen(long_json), &error);
+    ASSERT(!result2 && strcmp(error, "Invalid UTF-8") == 0, "Bytes past the vector fast path checked");
+
+    char deep[2 * JC_DOC_MAX_DEPTH + 64];
+    size_t n = (size_t)snprintf(deep, sizeof(deep), "{\"name\": \"Al\", \"age\": 1, \"x\": ");
+    for (int i = 0; i <= JC_DOC_MAX_DEPTH; i++) deep[n++] = '[';
+    bool result3 = jc_validate(schema, deep, n, &error);
+    ASSERT(!result3 && strcmp(error, "Nesting too deep") == 0, "Unknown values nest boundedly");
+    jc_schema_free(schema);
+}
+
+void test_binary_image() {
+    printf("\nTesting binary images:\n");
+    char* error = NULL;
+    typedef struct {
+        jc_str host;
+        int port;
+    } TestBackend;
+    typedef struct {
+        size_t rows;
+        jc_str names[4];
+        int weights[4];
+    } TestRoutes;
+    typedef struct {
+        int version;
+        jc_str name;
+        TestAddress address;
+        jc_array backends;
+        jc_str aliases[2];
+        TestRoutes routes;
+    } TestConfig;
+
+    JsonMap address_maps[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(((TestAddress*)0)->street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL},
+    };
+    JsonMap backend_maps[] = {
+        {"host", JC_OFFSET(TestBackend, host), 'S', 0, true, NULL},
+        {"port", JC_OFFSET(TestBackend, port), 'i', 0, true, NULL},
+    };
+    JsonMap route_maps[] = {
+        {"name", JC_OFFSET(TestRoutes, names), 'S', 0, true, NULL},
+        {"weight", JC_OFFSET(TestRoutes, weights), 'i', 0, true, NULL},
+    };
+    JsonMap backend_item = {"item", JC_STRIDE(sizeof(TestBackend)), 'o', 2, true, backend_maps};
+    JsonMap alias_item = {"item", NULL, 'S', 0, true, NULL};
+    JsonMap route_item = {"row", NULL, 'o', 2, true, route_maps};
+    JsonMap mappings[] = {
+        {"version", JC_OFFSET(TestConfig, version), 'i', 0, true, NULL},
+        {"name", JC_OFFSET(TestConfig, name), 'S', 0, true, NULL},
+        {"address", JC_OFFSET(TestConfig, address), 'o', 2, true, address_maps},
+        {"backends", JC_OFFSET(TestConfig, backends), 'v', 0, true, &backend_item},
+        {"aliases", JC_OFFSET(TestConfig, aliases), 'a', 2, true, &alias_item},
+        {"routes", JC_OFFSET(TestConfig, routes), 'c', 4, true, &route_item},
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 6, &error);
+
+    const char* json = "{\"version\": 3, \"name\": \"edge\\n\", \"address\": {\"street\": \"Elm\", \"number\": 4},"
+                       " \"backends\": [{\"host\": \"a.local\", \"port\": 80}, {\"host\": \"b.local\", \"port\": 81}],"
+                       " \"aliases\": [\"e1\", \"\"], \"routes\": [{\"name\": \"/api\", \"weight\": 5}, {\"name\": \"/\", \"weight\": 1}]}";
+    static char memory[1024];
+    jc_arena arena;
+    jc_arena_init(&arena, memory, sizeof(memory));
+    jc_options opts = {NULL, &arena, NULL, NULL, false, NULL};
+    const char* path = "test_image.bin";
+    bool result = jc_compile_to_binary(schema, sizeof(TestConfig), json, strlen(json), &opts, path, &error);
+    ASSERT(result, "JSON compiled to an image file");
+
+    jc_image image;
+    bool result2 = jc_image_load(path, schema, sizeof(TestConfig), &image, &error);
+    TestConfig* config = image.data;
+    ASSERT(result2 && config->version == 3 && strcmp(config->address.street, "Elm") == 0, "Image loads without parsing");
+    ASSERT(result2 && config->name.len == 6 && config->name.escaped && memcmp(config->name.ptr, "edge\\n", 6) == 0 &&
+           (const char*)config->name.ptr > (const char*)image.file.data &&
+           (const char*)config->name.ptr < (const char*)image.file.data + image.file.len, "String views point into the image");
+    TestBackend* backends = result2 ? config->backends.items : NULL;
+    ASSERT(result2 && config->backends.count == 2 && backends[1].port == 81 && backends[1].host.len == 7 &&
+           memcmp(backends[1].host.ptr, "b.local", 7) == 0, "Pointers inside array items rebased");
+    ASSERT(result2 && config->aliases[1].len == 0 && config->aliases[1].ptr && config->routes.rows == 2 &&
+           memcmp(config->routes.names[0].ptr, "/api", 4) == 0 && config->routes.weights[1] == 1,
+           "Fixed and columnar string views rebased");
+    if (result2) jc_image_close(&image);
+
+    // A changed layout must not load; callers fall back to the JSON
+    JsonMap changed[6];
+    memcpy(changed, mappings, sizeof(changed));
+    changed[0].type = 'I';
+    jc_schema* other = jc_schema_compile_offsets(changed, 6, &error);
+    bool result3 = jc_image_load(path, other, sizeof(TestConfig), &image, &error);
+    ASSERT(!result3 && strcmp(error, "Schema mismatch") == 0, "Fingerprint mismatch detected");
+    ASSERT(jc_schema_fingerprint(schema, sizeof(TestConfig)) != jc_schema_fingerprint(other, sizeof(TestConfig)) &&
+           jc_schema_fingerprint(schema, sizeof(TestConfig)) != jc_schema_fingerprint(schema, sizeof(TestConfig) + 8),
+           "Fingerprint covers types and struct size");
+    jc_schema_free(other);
+
+    // Corrupt an offset past the end of the file
+    FILE* fp = fopen(path, "r+b");
+    long name_ptr = JC_IMAGE_HEADER + (long)offsetof(TestConfig, name);
+    uintptr_t bad = 1u << 30;
+    fseek(fp, name_ptr, SEEK_SET);
+    fwrite(&bad, sizeof(bad), 1, fp);
+    fclose(fp);
+    bool result4 = jc_image_load(path, schema, sizeof(TestConfig), &image, &error);
+    ASSERT(!result4 && strcmp(error, "Corrupt image") == 0, "Offsets outside the image rejected");
+
+    fp = fopen(path, "wb");
+    fputs("{\"version\": 3}", fp);
+    fclose(fp);
+    bool result5 = jc_image_load(path, schema, sizeof(TestConfig), &image, &error);
+    ASSERT(!result5 && strcmp(error, "Not an image") == 0, "JSON is not taken for an image");
+    remove(path);
+
+    // Pointer-free structs are used in place
+    JsonMap plain[] = {
+        {"age", JC_OFFSET(TestPerson, age), 'i', 0, true, NULL},
+        {"address", JC_OFFSET(TestPerson, address), 'o', 2, true, address_maps},
+    };
+    jc_schema* plain_schema = jc_schema_compile_offsets(plain, 2, &error);
+    TestPerson person;
+    memset(&person, 0, sizeof(person));
+    person.age = 41;
+    person.address.number = 9;
+    jc_buffer buf = {NULL, 0, 0};
+    bool result6 = jc_image_write(plain_schema, &person, sizeof(person), &buf, &error);
+    fp = fopen(path, "wb");
+    fwrite(buf.data, 1, buf.len, fp);
+    fclose(fp);
+    bool result7 = result6 && jc_image_load(path, plain_schema, sizeof(person), &image, &error);
+    ASSERT(result7 && buf.len == JC_IMAGE_HEADER + sizeof(person) && ((TestPerson*)image.data)->age == 41 &&
+           ((TestPerson*)image.data)->address.number == 9, "Pointer-free image is header plus struct");
+    if (result7) jc_image_close(&image);
+    jc_buffer_free(&buf);
+    remove(path);
+    jc_schema_free(plain_schema);
+    jc_schema_free(schema);
+}
+
+void test_string_decoding() {
+    printf("\nTesting string decoding and UTF-8 validation:\n");
+    char* error = NULL;
+    typedef struct {
+        char text[16];
+        char small[5];
+        jc_str view;
+    } TestText;
+    JsonMap mappings[] = {
+        {"text", JC_OFFSET(TestText, text), 's', 16, true, NULL},
+        {"small", JC_OFFSET(TestText, small), 's', 5, false, NULL},
+        {"view", JC_OFFSET(TestText, view), 'S', 0, false, NULL},
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 3, &error);
+
+    TestText text;
+    const char* json = "{\"t\\u0065xt\": \"a\\n\\t\\\"\\\\\\/\\u00e9\\ud83d\\ude00\xc3\xa9\", \"small\": \"\\u00e9\\u00e9\","
+                       " \"view\": \"\\u00e9x\"}";
+    bool result = parse_json_into_n(schema, &text, json, strlen(json), &error);
+    ASSERT(result && strcmp(text.text, "a\n\t\"\\/\xc3\xa9\xf0\x9f\x98\x80\xc3\xa9") == 0, "Escapes and surrogate pairs decoded");
+    ASSERT(result && strcmp(text.small, "\xc3\xa9\xc3\xa9") == 0, "Length limit applies to decoded text");
+    ASSERT(result && text.view.escaped && text.view.len == 7, "Views keep their escapes for later decoding");
+    ASSERT(jc_validate(schema, json, strlen(json), &error), "Validation agrees on decoded lengths");
+
+    const char* bad[] = {
+        "{\"text\": \"a\\x\"}",
+        "{\"text\": \"\\ud83d\"}",
+        "{\"text\": \"\\ude00\"}",
+        "{\"text\": \"\\u12g4\"}",
+        "{\"text\": \"\xc0\xaf\"}",
+        "{\"text\": \"\xed\xa0\x80\"}",
+        "{\"text\": \"\xe2\x82\"}",
+        "{\"text\": \"\xf4\x90\x80\x80\"}",
+        "{\"text\": \"a\x01\"}",
+        "{\"text\": \"ok\", \"small\": \"\\u00e9\\u00e9x\"}",
+        "{\"text\": \"ok\", \"k\xff\": 1}",
+        "{\"text\": \"ok\", \"view\": \"\\q\"}",
+    };
+    const char* messages[] = {
+        "Invalid escape sequence", "Invalid unicode escape", "Invalid unicode escape", "Invalid unicode escape",
+        "Invalid UTF-8", "Invalid UTF-8", "Invalid UTF-8", "Invalid UTF-8", "Control character in string",
+        "String too long", "Invalid UTF-8", "Invalid escape sequence",
+    };
+    bool all = true;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (parse_json_into_n(schema, &text, bad[i], strlen(bad[i]), &error) || strcmp(error, messages[i]) != 0) {
+            printf("  %s: %s\n", bad[i], error);
+            all = false;
+        }
+    }
+    ASSERT(all, "Malformed escapes and UTF-8 rejected");
+
+    // Keys are limited by their decoded length, not their escaped text
+    char long_key[48], escaped_json[512];
+    char* w = escaped_json + sprintf(escaped_json, "{\"");
+    for (int i = 0; i < 43; i++) {
+        long_key[i] = (char)('a' + i % 26);
+        w += sprintf(w, "\\u%04x", long_key[i]);
+    }
+    long_key[43] = '\0';
+    sprintf(w, "\": \"hit\"}");
+    JsonMap long_map = {long_key, JC_OFFSET(TestText, text), 's', 16, true, NULL};
+    jc_schema* long_schema = jc_schema_compile_offsets(&long_map, 1, &error);
+    bool long_result = parse_json_into_n(long_schema, &text, escaped_json, strlen(escaped_json), &error);
+    ASSERT(long_result && strcmp(text.text, "hit") == 0, "Escaped key longer than JC_KEY_MAX matches once decoded");
+    w = escaped_json + sprintf(escaped_json, "{\"");
+    for (int i = 0; i < JC_KEY_MAX; i++) *w++ = 'k';
+    sprintf(w, "\\n\": 1}");
+    bool too_long = parse_json_into_n(long_schema, &text, escaped_json, strlen(escaped_json), &error);
+    ASSERT(!too_long && strcmp(error, "String too long") == 0, "Oversized decoded key rejected");
+    jc_schema_free(long_schema);
+
+    char written[128];
+    strcpy(text.text, "q\"\n\xc3\xa9");
+    text.small[0] = '\0';
+    text.view.ptr = "v";
+    text.view.len = 1;
+    text.view.escaped = false;
+    jc_serialize(schema, &text, written, sizeof(written));
+    TestText again;
+    bool result2 = parse_json_into(schema, &again, written, &error);
+    ASSERT(result2 && strcmp(again.text, text.text) == 0, "Decoded strings round-trip through the serializer");
+    jc_schema_free(schema);
+
+    // The stream decodes escapes and UTF-8 split across chunks
+    JsonMap address_fields[] = {
+        {"street", JC_OFFSET(TestAddress, street), 's', sizeof(((TestAddress*)0)->street), true, NULL},
+        {"number", JC_OFFSET(TestAddress, number), 'i', 0, true, NULL}
+    };
+    JsonMap fields[] = {
+        {"name", JC_OFFSET(TestStreamed, name), 's', sizeof(((TestStreamed*)0)->name), true, NULL},
+        {"age", JC_OFFSET(TestStreamed, age), 'i', 0, true, NULL},
+        {"ts", JC_OFFSET(TestStreamed, ts), 'I', 0, true, NULL},
+        {"address", JC_OFFSET(TestStreamed, address), 'o', 2, true, address_fields},
+    };
+    jc_schema* stream_schema = jc_schema_compile_offsets(fields, 4, &error);
+    const char* streamed = "{\"n\\u0061me\": \"x\\ud83d\\ude00\\u00e9\xc3\xa9\\\"\", \"age\": 1, \"ts\": 2,"
+                           " \"address\": {\"street\": \"\\\\s\", \"number\": 3}}";
+    bool every = true;
+    for (size_t chunk = 1; chunk <= 13; chunk++) {
+        TestStreamed out;
+        if (!feed_chunks(stream_schema, &out, streamed, chunk, chunk, &error) ||
+            strcmp(out.name, "x\xf0\x9f\x98\x80\xc3\xa9\xc3\xa9\"") != 0 || strcmp(out.address.street, "\\s") != 0) {
+            printf("  chunk %zu: %s\n", chunk, error);
+            every = false;
+        }
+    }
+    ASSERT(every, "Stream decodes escapes at any chunk split");
+
+    TestStreamed out;
+    bool result3 = feed_chunks(stream_schema, &out, "{\"name\": \"\xe2\x82\", \"age\": 1}", 12, 1, &error);
+    bool result4 = feed_chunks(stream_schema, &out, "{\"name\": \"\\ud83dx\", \"age\": 1}", 4, 4, &error);
+    ASSERT(!result3 && !result4, "Stream rejects bad UTF-8 and lone surrogates");
+    jc_schema_free(stream_schema);
+}
+
+void test_interned_strings() {
+    printf("\nTesting enums and interned strings:\n");
+    char* error = NULL;
+    typedef struct {
+        int status;
+        const char* city;
+        const char* tags[3];
+        int levels[2];
+    } TestRecord;
+    JsonMap statuses[] = {JC_NAME("active"), JC_NAME("idle"), JC_NAME("gone")};
+    JsonMap tag_item = {"item", NULL, 'n', 0, true, NULL};
+    JsonMap level_item = {"item", NULL, 'e', 3, true, statuses};
+    JsonMap mappings[] = {
+        {"status", JC_OFFSET(TestRecord, status), 'e', 3, true, statuses},
+        {"city", JC_OFFSET(TestRecord, city), 'n', 0, true, NULL},
+        {"tags", JC_OFFSET(TestRecord, tags), 'a', 3, false, &tag_item},
+        {"levels", JC_OFFSET(TestRecord, levels), 'a', 2, false, &level_item},
+    };
+    jc_schema* schema = jc_schema_compile_offsets(mappings, 4, &error);
+
+    jc_intern table = {0};
+    jc_options opts = {NULL, NULL, NULL, NULL, false, &table};
+    TestRecord a, b;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    const char* first = "{\"status\": \"idle\", \"city\": \"Oslo\", \"tags\": [\"x\", \"y\", \"x\"],"
+                        " \"levels\": [\"gone\", \"active\"]}";
+    const char* second = "{\"status\": \"g\\u006fne\", \"city\": \"Osl\\u006f\", \"tags\": [\"y\", \"z\", \"x\"]}";
+    bool result = parse_json_ex(schema, &a, first, strlen(first), &opts, &error) &&
+                  parse_json_ex(schema, &b, second, strlen(second), &opts, &error);
+    ASSERT(result && a.status == 1 && b.status == 2 && a.levels[0] == 2 && a.levels[1] == 0,
+           "Enum names map to their index");
+    ASSERT(result && a.city == b.city && strcmp(a.city, "Oslo") == 0 && a.tags[0] == a.tags[2] &&
+           a.tags[1] == b.tags[0] && a.tags[0] == b.tags[2] && table.count == 4,
+           "Equal strings intern to one pointer across parses");
+    ASSERT(jc_intern_find(&table, "Oslo", 4) == a.city && !jc_intern_find(&table, "Rome", 4) &&
+           jc_intern_add(&table, "z", 1) == b.tags[1], "Table lookups return the canonical copy");
+
+    // Growing the table keeps earlier strings where they were
+    const char* oslo = a.city;
+    char name[16];
+    for (int i = 0; i < 5000; i++) {
+        snprintf(name, sizeof(name), "city%d", i);
+        jc_intern_add(&table, name, strlen(name));
+    }
+    ASSERT(table.count == 5004 && jc_intern_find(&table, "Oslo", 4) == oslo && strcmp(oslo, "Oslo") == 0 &&
+           strcmp(jc_intern_find(&table, "city4999", 8), "city4999") == 0, "Strings stay put as the table grows");
+
+    const char* unknown = "{\"status\": \"asleep\", \"city\": \"Oslo\"}";
+    bool result2 = parse_json_ex(schema, &a, unknown, strlen(unknown), &opts, &error);
+    ASSERT(!result2 && strcmp(error, "Unknown enum value") == 0, "Unknown enum names rejected");
+    bool result3 = parse_json_into_n(schema, &a, first, strlen(first), &error);
+    ASSERT(!result3 && strcmp(error, "No intern table for interned string") == 0,
+           "Interned strings need a table");
+    ASSERT(jc_validate(schema, first, strlen(first), &error) && !jc_validate(schema, unknown, strlen(unknown), &error),
+           "Validation checks enum names");
+
+    char written[160];
+    jc_serialize(schema, &b, written, sizeof(written));
+    ASSERT(strcmp(written, "{\"status\":\"gone\",\"city\":\"Oslo\",\"tags\":[\"y\",\"z\",\"x\"],"
+                           "\"levels\":[\"active\",\"active\"]}") == 0,
+           "Enums and interned strings serialize as strings");
+
+    // Without a schema, names are found by scanning the list
+    int status = -1;
+    JsonMap plain[] = {{"status", &status, 'e', 3, true, statuses}};
+    bool result4 = parse_json("{\"status\": \"active\"}", plain, 1, &error);
+    ASSERT(result4 && status == 0, "Enums parse through uncompiled mappings");
+
+    jc_schema_free(schema);
+    jc_intern_free(&table);
+    ASSERT(table.count == 0 && !table.blocks, "Table released");
+}
+
+// Checks the batches of a compressed stream: records contiguous and in
+// ts order, and how many have an empty tag
+typedef struct {
+    size_t next;
+    size_t batches;
+    size_t stop_after;
+    bool in_order;
+    int64_t min_ts;
+    size_t untagged;
+} TestCollector;
+
+static bool collect_records(void* user, void* records, size_t count, size_t first_record) {
+    TestCollector* c = user;
+    const TestRecord* r = records;
+    if (first_record != c->next) c->in_order = false;
+    for (size_t i = 0; i < count; i++) {
+        if (r[i].ts < c->min_ts) c->in_order = false;
+        c->min_ts = r[i].ts + 1;
+        if (!r[i].tag[0]) c->untagged++;
+    }
+    c->next = first_record + count;
+    return ++c->batches != c->stop_after;
+}
+
+static void write_file(const char* path, const void* data, size_t len) {
+    FILE* fp = fopen(path, "wb");
+    fwrite(data, 1, len, fp);
+    fclose(fp);
+}
+
+void test_compressed_stream() {
+    printf("\nTesting compressed NDJSON pipelines:\n");
+    char* error = NULL;
+    JsonMap fields[] = {
+        {"ts", JC_OFFSET(TestRecord, ts), 'I', 0, true, NULL},
+        {"id", JC_OFFSET(TestRecord, id), 'i', 0, true, NULL},
+        {"tag", JC_OFFSET(TestRecord, tag), 's', sizeof(((TestRecord*)0)->tag), false, NULL}
+    };
+    jc_schema* schema = jc_schema_compile_offsets(fields, 3, &error);
+
+    // 3000 records over many 4 KiB buffers, one failing, one blank line
+    // and no newline at the end
+    size_t cap = 3000 * 48, len = 0;
+    char* text = malloc(cap);
+    size_t bad_offset = 0;
+    for (int i = 0; i < 3000; i++) {
+        if (i == 2000) text[len++] = '\n';
+        if (i == 1234) {
+            bad_offset = len;
+            len += (size_t)snprintf(text + len, cap - len, "{\"ts\": %d, \"id\": }", i);
+        } else {
+            len += (size_t)snprintf(text + len, cap - len, "{\"ts\": %d, \"id\": 1, \"tag\": \"t%d\"}", i, i % 100);
+        }
+        if (i < 2999) text[len++] = '\n';
+    }
+    const char* path = "test_stream.ndjson";
+    write_file(path, text, len);
+
+    TestCollector c = {0, 0, 0, true, 0, 0};
+    jc_record_error errors[4];
+    jc_ndjson_stats stats = {0};
+    stats.errors = errors;
+    stats.max_errors = 4;
+    bool result = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), collect_records, &c, 4, &stats, &error);
+    ASSERT(result && c.in_order && c.next == 2999 && c.batches > 10 && c.untagged == 0,
+           "Plain NDJSON delivered in order across buffers, without the failed record");
+    ASSERT(stats.records == 3000 && stats.failed == 1 && stats.error_count == 1 && errors[0].record == 1234 &&
+           errors[0].offset == bad_offset && stats.bytes_consumed == len, "Pipeline reports records and errors");
+
+    c = (TestCollector){0, 0, 3, true, 0, 0};
+    bool result2 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), collect_records, &c, 2, &stats, &error);
+    ASSERT(result2 && c.batches == 3 && stats.records == c.next && stats.records < 3000, "Callback stops the pipeline");
+
+#if defined(JC_ZLIB)
+    gzFile gz = gzopen(path, "wb");
+    gzwrite(gz, text, (unsigned)len);
+    gzclose(gz);
+    c = (TestCollector){0, 0, 0, true, 0, 0};
+    bool result3 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), collect_records, &c, 3, &stats, &error);
+    ASSERT(result3 && c.in_order && c.next == 2999 && stats.failed == 1 && errors[0].offset == bad_offset,
+           "gzip input decompressed while parsing");
+
+    // max_errors without an errors array only counts failures
+    jc_ndjson_stats counts = {0};
+    counts.max_errors = 4;
+    c = (TestCollector){0, 0, 0, true, 0, 0};
+    bool counted = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), collect_records, &c, 3, &counts, &error);
+    ASSERT(counted && c.next == 2999 && counts.failed == 1 && counts.error_count == 0,
+           "Failures counted when no error array is given");
+
+    FILE* fp = fopen(path, "rb");
+    char packed[8192];
+    size_t packed_len = fread(packed, 1, sizeof(packed), fp);
+    fclose(fp);
+    write_file(path, packed, packed_len / 2);
+    bool result4 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), NULL, NULL, 2, &stats, &error);
+    ASSERT(!result4 && strcmp(error, "Truncated gzip data") == 0, "Truncated gzip input rejected");
+#endif
+#if defined(JC_ZSTD)
+    size_t zcap = ZSTD_compressBound(len);
+    char* z = malloc(zcap);
+    size_t zlen = ZSTD_compress(z, zcap, text, len, 3);
+    write_file(path, z, zlen);
+    c = (TestCollector){0, 0, 0, true, 0, 0};
+    bool result5 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), collect_records, &c, 3, &stats, &error);
+    ASSERT(result5 && c.in_order && c.next == 2999 && stats.failed == 1, "zstd input decompressed while parsing");
+    write_file(path, z, zlen / 2);
+    bool result6 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), NULL, NULL, 2, &stats, &error);
+    ASSERT(!result6 && strcmp(error, "Truncated zstd data") == 0, "Truncated zstd input rejected");
+    free(z);
+#endif
+
+    // Reused buffers must not leak a tag into records that omit it
+    size_t mixed_len = 0;
+    for (int i = 0; i < 600; i++) {
+        mixed_len += (size_t)snprintf(text + mixed_len, cap - mixed_len, i < 300 ?
+                                      "{\"ts\": %d, \"id\": 1, \"tag\": \"x\"}\n" : "{\"ts\": %d, \"id\": 1}\n", i);
+    }
+    write_file(path, text, mixed_len);
+    c = (TestCollector){0, 0, 0, true, 0, 0};
+    bool mixed = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), collect_records, &c, 1, NULL, &error);
+    ASSERT(mixed && c.next == 600 && c.untagged == 300, "Omitted fields are zero in reused buffers");
+
+    memset(text, 'x', 5000);
+    write_file(path, text, 5000);
+    bool result7 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), NULL, NULL, 2, &stats, &error);
+    ASSERT(!result7 && strcmp(error, "Record too long") == 0, "Records longer than a buffer rejected");
+    remove(path);
+    bool result8 = jc_parse_compressed_stream(path, schema, sizeof(TestRecord), NULL, NULL, 2, &stats, &error);
+    ASSERT(!result8 && strcmp(error, "Cannot open file") == 0, "Missing file reported");
+
+    free(text);
+    jc_schema_free(schema);
+}
+
+JC_STRUCT(GenPoint, JC_INT(x) JC_INT(y))
+JC_STRUCT(GenShape,
+    JC_STR(name, 16)
+    JC_OBJ(origin, GenPoint)
+    JC_INT64(id)
+    JC_UINT64(mask)
+    JC_BOOL(visible)
+    JC_FLOAT(alpha)
+    JC_OPTIONAL(JC_DOUBLE(scale))
+    JC_OPTIONAL(JC_INT(layer)))
+
+void test_generated_parser() {
+    printf("\nTesting generated parsers:\n");
+    char* error = NULL;
+    GenShape shape;
+    memset(&shape, 0, sizeof(shape));
+
+    const char* json = "{\"name\": \"tri\", \"origin\": {\"y\": -2, \"x\": 1}, \"extra\": [1, {\"a\": 2}],"
+                       " \"id\": -9000000000, \"mask\": 18446744073709551615, \"visible\": true,"
+                       " \"alpha\": 0.5, \"scale\": 2.25}";
+    jc_stats stats;
+    jc_options opts = {NULL, NULL, NULL, &stats, false, NULL};
+    bool result = jc_parse_GenShape(&shape, json, strlen(json), &opts, &error);
+    ASSERT(result && strcmp(shape.name, "tri") == 0 && shape.origin.x == 1 && shape.origin.y == -2,
+           "Generated parser fills strings and nested structs");
+    ASSERT(shape.id == -9000000000LL && shape.mask == UINT64_MAX && shape.visible && shape.alpha == 0.5f &&
+           shape.scale == 2.25 && shape.layer == 0, "Generated parser fills every field type");
+    ASSERT(stats.fields_matched == 9 && stats.keys_skipped == 1 && stats.max_depth == 2,
+           "Generated parser reports statistics");
+
+    const char* missing = "{\"name\": \"a\", \"origin\": {\"x\": 1}, \"id\": 1, \"mask\": 1,"
+                          " \"visible\": false, \"alpha\": 1}";
+    bool result2 = jc_parse_GenShape(&shape, missing, strlen(missing), NULL, &error);
+    ASSERT(!result2 && strcmp(error, "Missing required field in nested object") == 0,
+           "Generated parser checks required nested fields");
+
+    const char* optional = "{\"name\": \"b\", \"origin\": {\"x\": 1, \"y\": 2}, \"id\": 1, \"mask\": 1,"
+                           " \"visible\": false, \"alpha\": 1, \"layer\": 3}";
+    bool result3 = jc_parse_GenShape(&shape, optional, strlen(optional), NULL, &error);
+    ASSERT(result3 && shape.layer == 3 && !shape.visible, "Optional fields may be omitted");
+
+    const char* bad = "{\"name\": \"too long for sixteen\"}";
+    bool result4 = jc_parse_GenShape(&shape, bad, strlen(bad), NULL, &error);
+    ASSERT(!result4 && strcmp(error, "String too long") == 0, "Generated parser bounds strings");
+
+    const char* trailing = "{\"x\": 1, \"y\": 2,}";
+    GenPoint point;
+    bool result5 = jc_parse_GenPoint(&point, trailing, strlen(trailing), NULL, &error);
+    ASSERT(!result5 && strcmp(error, "Trailing comma") == 0, "Generated parser rejects trailing commas");
+
+    const char* early = "{\"y\": 2, \"skip\": {}, \"x\": 1, \"rest\": [unparsed";
+    jc_options stop = {NULL, NULL, NULL, &stats, true, NULL};
+    bool result6 = jc_parse_GenPoint(&point, early, strlen(early), &stop, &error);
+    ASSERT(result6 && point.x == 1 && point.y == 2 && stats.bytes == (size_t)(strstr(early, ", \"rest") - early),
+           "Generated parser stops when all fields are filled");
+}
+
 int main() {
     printf("Running JSON parser tests...\n");
 
@@ -156,6 +1926,30 @@ int main() {
     test_nested_object();
     test_arrays();
     test_error_cases();
+    test_compiled_schema();
+    test_offset_schema();
+    test_whitespace_and_long_strings();
+    test_numbers();
+    test_ndjson();
+    test_stream();
+    test_length_bounded();
+    test_no_allocations();
+    test_serialize();
+    test_variable_arrays();
+    test_string_views();
+    test_typed_arrays();
+    test_skip_unknown();
+    test_stats();
+    test_generated_parser();
+    test_key_prediction();
+    test_path_queries();
+    test_parallel_array();
+    test_document_tape();
+    test_validate();
+    test_binary_image();
+    test_string_decoding();
+    test_interned_strings();
+    test_compressed_stream();
 
     printf("\nTest Summary:\n");
     printf("✓ Passed: %d\n", passed_tests);